@@ -13,11 +13,11 @@ Scatter出現在3-5轉輪，Wild出現在2-5轉輪，可替代除S外之任意
 依處理器thread數 → 分數個worker → 各自做以下1-7 → 彙整輸出
 
 (1) 轉窗（主遊戲）
-        呼叫：spinWindow(rng, reelsMG, &w)
+        呼叫：spinEval<MG>(game, rng, &w) → spinWindow<MG>(def, rng, &w)（--engine column 時改查列 ID 表）
         對 5 軸各抽一個 stop，視窗填入 stop、stop+1、stop+2（三格環迴）。
 
 (2) 算主遊戲線獎
-        呼叫：evalAllLines(&w, &payMG)
+        呼叫：evalAllLines<MG>(def, &w)（內建線圖於編譯期展開 25 線；--game 載入的線圖改為迴圈）
         走 25 條線，逐條呼叫 linePay(...) 加總。
         linePay：
         湊到　3/4/5 連，回傳 pay[target][len-3]（未乘線注）。
@@ -26,16 +26,17 @@ Scatter出現在3-5轉輪，Wild出現在2-5轉輪，可替代除S外之任意
         呼叫：countScatter(&w) → 數 5×3 視窗中的 S
         < 3：本把結束；若 mgLine == 0 則 deadSpins++。
         >= 3：觸發 FG，triggerCount++，並決定觸發倍率：
-         mul = fgMulByScatter(s) → 3S/4S/5S → ×10/×50/×100
+         mul = fgMulByScatter(def, s) → 3S/4S/5S → 內建 ×10/×50/×100（設定檔 fg_mul 可改）
 
 (4) 跑「一整串」FG
-        呼叫：playFG(rng, &w) 回傳 (spins, base, retri, zeroBatches, totalBatches)
+        呼叫：playFG(game, rngFG, &w) 回傳 (spins, base, retri, zeroBatches, totalBatches)
+        （FG 使用與 MG 分開的亂數流，批次模式與逐把模式因此能逐位元一致）
 
         playFG 內每一轉：
-            spinWindow(rng, reelsFG, &w)
-            win = evalAllLines(&w, &payFG) * betPerLine
-            若 countScatter(&w) >= 3：queue += 5，retri++
-            以 5 轉為一批次，累計 batchWin；若整批為 0，zeroBatches++
+            spinWindow<FG>(rng, &w)
+            win = evalAllLines<FG>(&w)（整數線注單位；betPerLine 只在報表換算）
+            若 countScatter(&w) >= 3：queue += fgSpins（內建 5），retri++
+            以 fgSpins 轉為一批次，累計 batchWin；若整批為 0，zeroBatches++
             備註：base 為整串 FG 未乘觸發倍率的總派彩
 
 (5) 把整串 FG 派彩加權、累計
@@ -44,30 +45,139 @@ Scatter出現在3-5轉輪，Wild出現在2-5轉輪，可替代除S外之任意
 (6) 更新單把峰值與分層
         ≥20→big，≥60→mega，≥100→super，≥300→holy，≥500→jumbo，≥1000→jojo；更新 maxSingleSpin。
 
-(7) 進度心跳（降低同步成本）
-        每把增加 bumpCnt；每達 4096（bump）時; atomic 加到全域 spinsDone（Add 4096），bumpCnt 清零。
-        背景心跳執行緒每秒讀 spinsDone，輸出進度/速度/ETA。
+(7) 進度與即時統計（降低同步成本）
+        每把增加 bumpCnt；每達 4096（bump）時; atomic 加到全域 spinsDone（Add 4096），
+        並把本 worker 的累計 Stats 寫入自己的 seqlock 槽位，bumpCnt 清零。
+        遙測執行緒每秒讀 spinsDone 與各槽位快照，輸出進度/速度/ETA 與累計 RTP/CI/觸發率/大獎數，結束時 join。
+
+命令列參數：
+    --spins N     總轉數（預設 10 億）
+    --threads N   worker 數（預設硬體 thread 數）
+    --kernel K    線獎核心 scalar|bitboard|sse2|avx2|auto（預設 auto；非 scalar 時啟動先自檢）
+    --engine E    求值引擎 window|column（column：停點 → 列 ID，前 3 軸前綴查表；啟動時輸出記憶體用量）
+    --rng R       亂數產生器 mt|xoshiro|splitmix|philox（預設 mt；停點一律以 Lemire 無偏取值）
+    --rng-bench   輸出各亂數產生器吞吐量（原始輸出 / 停點 / MG 轉）後結束
+    --bench FILE  微基準（spinWindow/linePay/evalAllLines/evalLines/countScatter/playFG/MG 轉，ns/op 與 x86 TSC/op）
+                  + 1..N（--threads）執行緒強擴展，寫成 JSON 供跨版本比對；--bench-spins 設擴展總轉數（預設 2^24）
+    （編譯時加 -DSLOT_PROFILE：排程結束另輸出 [PROF] 各 worker spins/s、MG/FG 時間占比、FG 串長/再觸發代數分佈與最長一串）
+    --batch N     批次（SoA）模式：每區塊 N 把分階段抽停點/填窗/線獎/數 S，再依序跑觸發的 FG（0=逐把）
+    --batch-check N   同一種子下比對批次與逐把路徑的整份統計後結束
+    --pipeline    MG/FG 管線模式：MG 執行緒逐塊跑主遊戲後把塊號推入無鎖佇列，FG 執行緒池取出跑該塊的 playFG；
+                  子流依塊號，結果與兩池大小無關；輸出佇列深度與各段吞吐量
+    --sched steal|static  工作竊取（預設）：轉數切成固定塊輪流發到各 worker 佇列，閒者向他人尾端偷；static 為舊的平分
+    --chunk N     每塊轉數（預設 1048576）；每塊用 (seed, 塊號) 導出的獨立 MG/FG 子流（Philox 直接以計數區段切分），
+                  各塊 Stats 依塊號順序合併 → 同 seed/spins/chunk/rng 不論 --threads 多少結果逐位元相同
+    --seed S      指定種子（未指定取時鐘；報表標頭會印出，供重現）
+    --chunk-range A:B  只跑第 [A, B) 塊（B 省略 = 到最後），用來單獨重跑可疑區段
+    --shard i/N   多行程/多機分片：只跑總塊數均分後的第 i 段（須指定 --seed），該段合併後的 Stats 寫入版本化二進位檔
+                  （--shard-out FILE，預設 shard-i-of-N.shard）
+    --sessions N  玩家 session 模擬：N 個獨立 session，各以 --bankroll B（×bet，預設 100）起，每把扣一注，
+                  至 --stop-win W（餘額達初始 ×W，預設 2；0 = 不設）/ --stop-loss L（虧損達初始 ×L，預設 1 = 付不起才停）/
+                  破產 / 轉滿 --session-spins M（預設 1000）為止；SoA 每條 worker 同時推進 256 個 session，
+                  輸出達標/破產機率、session 長度/最終/峰值餘額分佈、停損時間與前 --first-k K（預設 100）把內見到各級大獎的比例
+    --serve       單把服務模式：stdin 每行一個請求（整數 0 ≤ K < 2^59 = 以 (seed, K) 子流重放；空行/spin = 下一把），stdout 每行回一筆
+                  JSON（停點、MG 贏分、S 數、倍率、FG 逐轉停點/贏分、總贏分）；EOF 時 stderr 輸出 spin() 與整個請求的
+                  p50/p99/p99.9/max 延遲（µs）。--serve-socket PATH 改監聽 Unix socket，每連線一條執行緒共用同一 SlotEngine；
+                  SIGINT/SIGTERM 時停止接受連線、關閉既有連線並等其結束後輸出同樣的延遲摘要
+    （嵌入：#define SLOT_NO_MAIN 後 #include 本檔，以 SlotEngine(game[, kernel]).spin(rng, record) 取得與模擬器同一份數學的單把結果）
+    --merge FILE  （可重複）合併分片檔，依塊號排序後輸出與單機一次跑完逐位元相同的報表；缺片時警告並只計已有分片
+    --target-se X / --target-halfwidth H   精度目標：per-spin RTP 的 SE ≤ X（或 95% 半寬 ≤ H）即停，--spins 為上限；
+                  只依從第 0 塊起連續完成的前綴判定，另需觸發數 ≥ --min-triggers、轉數 ≥ --min-spins，
+                  且達標後再多 max(8 塊, 10% 塊數) 仍成立
+    --min-triggers N   精度目標模式停止前最少 FG 觸發數（預設 10000）
+    --min-spins N      精度目標模式停止前最少轉數（預設 0 = 不限）
+    --telemetry FILE   每秒把累計 RTP/SE/CI/觸發率/大獎數寫入 FILE（供儀表板 tail）
+    --telemetry-format jsonl|prom  jsonl 每秒附加一行 JSON（預設）；prom 為 Prometheus 文字格式，每秒整檔取代
+    --checkpoint FILE  背景執行緒定時把連續完成前綴的合併 Stats 與亂序完成塊寫入二進位檢查點（暫存檔 + rename）
+    --checkpoint-every SEC  檢查點間隔秒數（預設 60）
+    --resume FILE      由檢查點續跑（seed/spins/chunk/rng/--breakdown 取自檔案），總計與不中斷執行逐位元相同
+    --affinity none|all|physical  綁核：all 綁全部邏輯核心，physical 每實體核一條（未給 --threads 時 worker 數隨之）；
+                  stderr 輸出各 worker 完成轉數、偷取塊數與閒置時間
+    --mg-threads A / --fg-threads B   管線模式下兩池大小（預設依 --threads 約 3:1 分配）
+    --game FILE   由設定檔載入遊戲定義（輪帶、賠率表、線圖、FG 倍率/轉數、獎項門檻；格式見 loadGameDef），
+                  可重複指定多個變體：共用同一 worker 池，各變體同塊號使用相同亂數子流，各輸出一份報表
+    --interleave  多個 --game 時交錯發塊（同塊號的各變體相鄰），否則逐變體依序跑完
+    --breakdown   RTP 貢獻矩陣：符號 × 3/4/5 連 × MG/FG、逐線、自然 vs 含 W 的贏分與命中次數
+                  （template 策略實例化；未指定時編譯出的路徑與原本相同，不付任何成本）
+    --percentiles LIST   報表分位數（%，逗號分隔；預設 50,90,99,99.9,99.99,99.999），單把/MG/FG 串各列一值
+    --hist-tiers LIST    報表額外門檻（×bet，逗號分隔），列出 P(單把 ≥ 門檻)
+    --hist-csv FILE      匯出整份分佈直方圖（單把、MG 線獎、FG 串 base；HDR 式 log-linear，每 2 的冪 32 格）
+    --fg-cache N  先模擬 N 串 FG 建成結果分佈（相同結果合併），觸發時以 Walker alias 表 O(1) 抽樣取代實跑 playFG
+    --fg-cache-file FILE   快取存檔／載入（POSIX 以 mmap 直接映射）；定義雜湊不符或串數不同時重建覆寫
+    --fg-cache-check M     另實跑 M 串與快取比對（均值 z、KS、分位、超出快取最大值的尾端串數），提示快取是否太小
+    --conditional 條件蒙地卡羅：MG 窮舉一次取精確線獎/觸發分佈，--spins 改為模擬的 FG 串數；
+                  合成總 RTP、每把標準差與獎項機率（含 SE），FG 主導的高波動下同 CI 寬度所需 CPU 遠少於一般模擬
+    --sweep FILE  參數掃描（可重複）：以內建或單一 --game 為基準，FILE 只寫與基準不同的鍵（輪帶/賠率…）；
+                  每把只抽一次停點供所有變體共用（CRN），輸出依 RTP 排名的表：RTP、觸發率、波動度與對基準的配對 95% CI
+    --sweep-target X   掃描排名改依 |RTP − X|（調往目標 RTP 時用）
+    --kernel-check N  以 N 個隨機視窗比對各核心與 scalar linePay，輸出耗時後結束
+    --exact       不跑 Monte Carlo；窮舉 MG 五軸所有停點組合（49×50×51×57×52），
+                  輸出精確 MG RTP、3S/4S/5S 觸發機率與 dead spin 比例，可直接與模擬結果比對；
+                  再窮舉 FG 單轉並以再觸發 DP 求整串 FG base 分佈，輸出各倍率 FG RTP、
+                  總 RTP（對照 excelRTP）與各獎項/≥1000× 細分之精確機率
 */
 
 #ifdef _WIN32
-#include <windows.h> // 把 Windows 主控台碼頁切到 UTF-8（避免 中文/符號 亂碼）
+#include <windows.h> // 把 Windows 主控台碼頁切到 UTF-8（避免 中文/符號 亂碼）；綁核
+#endif
+#if defined(__linux__)
+#include <pthread.h> // pthread_setaffinity_np（--affinity）
+#include <sched.h>
+#endif
+#if !defined(_WIN32)
+#include <fcntl.h> // mmap（--fg-cache-file）
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h> // Unix socket（--serve-socket）
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// x86/x64：SSE2/AVX2 線獎核心（AVX2 於執行期偵測後才使用）
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+#define SLOT_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+#if defined(__GNUC__) || defined(__clang__)
+#define SLOT_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SLOT_TARGET_AVX2
 #endif
 
 #include <algorithm>
 #include <array>
 #include <atomic>
+#include <bitset>
 #include <chrono>
+#include <cctype>
+#include <cerrno>
+#include <climits>
 #include <cmath>
+#include <csignal>
+#include <complex>
+#include <condition_variable>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
+#include <map>
+#include <mutex>
 #include <random>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <thread>
 #include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <functional>
 using namespace std;
@@ -75,11 +185,17 @@ using namespace std;
 /**************
  * 參數（可調）
  **************/
+#ifndef SLOT_NO_MAIN
 static long long numSpins = 1000000000LL;                    // 總轉數（預設 10 億）
 static double betPerLine = 0.04;                             // 每線押注
 static int numWorkers = (int)thread::hardware_concurrency(); // 併發 worker(視硬體thread數而定)
 static double excelRTP = 0.965984;                           // Excel 試算 RTP，於輸出驗證；設負值則不比較
+static bool exactMode = false;                               // --exact：窮舉輪帶全週期，取代 Monte Carlo
+static bool rngBenchMode = false;                            // --rng-bench：各亂數產生器吞吐量後結束
+static long long batchCheckSpins = 0;                        // --batch-check N：比對批次與逐把路徑後結束
+static long long kernelCheckWindows = 0;                     // --kernel-check N：以 N 個隨機視窗自檢線獎核心後結束
 
+#endif
 /**************
  * 線數
  **************/
@@ -104,12 +220,24 @@ enum Sym : uint8_t
 };
 
 /**************
- * 賠率表 pay[符號][streak-3] = 倍率
+ * 遊戲模式：輪帶、賠率表與轉窗/線獎函式以此為 template 參數特化
+ **************/
+enum GameMode : uint8_t
+{
+    MG, // 主遊戲
+    FG  // 免費遊戲
+};
+
+/**************
+ * 賠率表 pay[符號][streak-3] = 倍率（整數，單位 = 1 線注）
  * MG：主遊戲；FG：免費遊戲（倍率較高）
+ * 模擬熱路徑全程以「線注單位」整數累加（線獎、FG base × 觸發倍率皆為整數），betPerLine 只在報表換算金額
  **************/
-static array<array<double, 3>, NumSymbols> payMG = []
+using PayTable = array<array<int32_t, 3>, NumSymbols>;
+
+static constexpr PayTable payMG = []
 {
-    array<array<double, 3>, NumSymbols> p{};
+    PayTable p{};
     p[S9] = {5, 10, 40};
     p[S10] = {5, 15, 50};
     p[SJ] = {10, 15, 75};
@@ -121,9 +249,9 @@ static array<array<double, 3>, NumSymbols> payMG = []
     return p;
 }();
 
-static array<array<double, 3>, NumSymbols> payFG = []
+static constexpr PayTable payFG = []
 {
-    array<array<double, 3>, NumSymbols> p{};
+    PayTable p{};
     p[S9] = {10, 15, 100};
     p[S10] = {10, 25, 125};
     p[SJ] = {15, 30, 150};
@@ -138,76 +266,464 @@ static array<array<double, 3>, NumSymbols> payFG = []
 /**************
  * 線圖：25 線（0=上,1=中,2=下）
  **************/
-static const array<array<uint8_t, 5>, numLines> lines = {{{1, 1, 1, 1, 1}, {0, 0, 0, 0, 0}, {2, 2, 2, 2, 2}, {0, 1, 2, 1, 0}, {2, 1, 0, 1, 2}, {0, 0, 1, 2, 2}, {2, 2, 1, 0, 0}, {1, 2, 2, 2, 1}, {1, 0, 0, 0, 1}, {0, 1, 1, 1, 0}, {2, 1, 1, 1, 2}, {1, 0, 1, 2, 1}, {1, 2, 1, 0, 1}, {0, 0, 2, 2, 0}, {2, 2, 0, 0, 2}, {0, 2, 2, 2, 0}, {2, 0, 0, 0, 2}, {1, 0, 2, 0, 1}, {1, 2, 0, 2, 1}, {0, 1, 0, 1, 0}, {2, 1, 2, 1, 2}, {1, 1, 0, 1, 1}, {1, 1, 2, 1, 1}, {0, 2, 0, 2, 0}, {2, 0, 2, 0, 2}}};
+using LineSet = array<array<uint8_t, 5>, numLines>;
+static constexpr LineSet builtinLines = {{{1, 1, 1, 1, 1}, {0, 0, 0, 0, 0}, {2, 2, 2, 2, 2}, {0, 1, 2, 1, 0}, {2, 1, 0, 1, 2}, {0, 0, 1, 2, 2}, {2, 2, 1, 0, 0}, {1, 2, 2, 2, 1}, {1, 0, 0, 0, 1}, {0, 1, 1, 1, 0}, {2, 1, 1, 1, 2}, {1, 0, 1, 2, 1}, {1, 2, 1, 0, 1}, {0, 0, 2, 2, 0}, {2, 2, 0, 0, 2}, {0, 2, 2, 2, 0}, {2, 0, 0, 0, 2}, {1, 0, 2, 0, 1}, {1, 2, 0, 2, 1}, {0, 1, 0, 1, 0}, {2, 1, 2, 1, 2}, {1, 1, 0, 1, 1}, {1, 1, 2, 1, 1}, {0, 2, 0, 2, 0}, {2, 0, 2, 0, 2}}};
 
 /**************
- * 輪帶（啟動時：字串→符號碼）
+ * 輪帶（編譯期轉碼：字串 → 符號碼，啟動時不做任何字串解析）
+ * 每軸尾端補上開頭 2 格，視窗取 stop、stop+1、stop+2 免環迴取模
  **************/
-static vector<vector<string>> reelsMGstr = {
+constexpr int MAX_STRIP = 126;              // 單軸最長停點數
+constexpr int STRIP_STRIDE = MAX_STRIP + 2; // 含補齊 2 格 = 128 bytes（兩條 cache line）
+
+struct ReelSet
+{
+    alignas(64) uint8_t sym[5][STRIP_STRIDE] = {};
+    int len[5] = {};
+};
+
+static constexpr const char *reelsMGstr[5] = {
     // Reel 1
-    {"10", "Q", "9", "R", "B", "J", "10", "K", "Q", "10", "J", "Q", "10", "J", "B", "Q", "J", "J", "10", "Q", "9", "Q", "Q", "B", "9", "J", "B", "F", "K", "Q", "K", "B", "B", "Q", "B", "10", "J", "Q", "10", "B", "F", "K", "R", "B", "R", "10", "9", "J", "Q"},
+    "10 Q 9 R B J 10 K Q 10 J Q 10 J B Q J J 10 Q 9 Q Q B 9 J B F K Q K B B Q B 10 J Q 10 B F K R B R 10 9 J Q",
     // Reel 2
-    {"9", "K", "J", "9", "Q", "B", "9", "K", "B", "9", "K", "9", "9", "W", "10", "J", "R", "B", "10", "Q", "W", "R", "K", "9", "10", "K", "Q", "K", "B", "F", "K", "R", "K", "Q", "B", "K", "9", "B", "F", "10", "R", "Q", "K", "R", "9", "K", "W", "9", "10", "9"},
+    "9 K J 9 Q B 9 K B 9 K 9 9 W 10 J R B 10 Q W R K 9 10 K Q K B F K R K Q B K 9 B F 10 R Q K R 9 K W 9 10 9",
     // Reel 3
-    {"9", "9", "9", "10", "S", "9", "10", "9", "10", "10", "9", "10", "S", "10", "J", "10", "10", "9", "J", "F", "J", "10", "J", "J", "Q", "J", "R", "Q", "Q", "J", "Q", "F", "K", "K", "B", "B", "J", "F", "F", "J", "B", "K", "R", "R", "F", "F", "R", "W", "9", "10", "J"},
+    "9 9 9 10 S 9 10 9 10 10 9 10 S 10 J 10 10 9 J F J 10 J J Q J R Q Q J Q F K K B B J F F J B K R R F F R W 9 10 J",
     // Reel 4
-    {"9", "9", "10", "9", "9", "J", "9", "Q", "9", "9", "10", "10", "9", "10", "10", "J", "J", "9", "J", "J", "Q", "R", "J", "J", "Q", "Q", "9", "Q", "J", "Q", "W", "W", "W", "W", "K", "F", "K", "Q", "B", "B", "W", "W", "W", "W", "R", "J", "B", "K", "Q", "Q", "B", "Q", "F", "K", "10", "S", "S"},
+    "9 9 10 9 9 J 9 Q 9 9 10 10 9 10 10 J J 9 J J Q R J J Q Q 9 Q J Q W W W W K F K Q B B W W W W R J B K Q Q B Q F K 10 S S",
     // Reel 5
-    {"9", "9", "10", "10", "Q", "W", "J", "J", "J", "Q", "Q", "K", "W", "Q", "Q", "10", "Q", "K", "K", "Q", "K", "K", "F", "B", "K", "B", "B", "10", "B", "K", "B", "B", "J", "B", "R", "B", "F", "F", "K", "F", "B", "F", "F", "R", "B", "Q", "W", "F", "B", "10", "S", "S"}};
+    "9 9 10 10 Q W J J J Q Q K W Q Q 10 Q K K Q K K F B K B B 10 B K B B J B R B F F K F B F F R B Q W F B 10 S S"};
 
-static vector<vector<string>> reelsFGstr = {
+static constexpr const char *reelsFGstr[5] = {
     // Reel 1
-    {"10", "Q", "B", "10", "Q", "J", "9", "B", "9", "Q", "J", "K", "J", "10", "J", "Q", "J", "B", "Q", "K", "Q", "10", "Q", "B", "Q", "R", "B", "K", "J", "Q", "10", "K", "9", "Q", "B", "R", "J", "Q", "10", "B", "Q", "F", "R", "10", "Q", "10", "9", "J", "Q", "10", "B", "10", "Q", "J", "10", "J", "F", "J", "B", "10", "Q", "J", "B", "Q", "10", "Q", "10", "J"},
+    "10 Q B 10 Q J 9 B 9 Q J K J 10 J Q J B Q K Q 10 Q B Q R B K J Q 10 K 9 Q B R J Q 10 B Q F R 10 Q 10 9 J Q 10 B 10 Q J 10 J F J B 10 Q J B Q 10 Q 10 J",
     // Reel 2
-    {"9", "R", "9", "K", "Q", "B", "K", "J", "F", "B", "9", "K", "9", "B", "W", "K", "9", "J", "K", "W", "Q", "K", "F", "K", "R", "10", "K", "9", "K", "B", "K", "R", "K", "9", "B", "9", "K", "9", "B", "10", "B", "K", "R", "Q", "R", "K", "10", "F", "K", "9", "10", "K", "9", "K", "Q", "K", "R", "9", "K", "9", "K", "F", "R", "9", "K", "10", "Q", "K"},
+    "9 R 9 K Q B K J F B 9 K 9 B W K 9 J K W Q K F K R 10 K 9 K B K R K 9 B 9 K 9 B 10 B K R Q R K 10 F K 9 10 K 9 K Q K R 9 K 9 K F R 9 K 10 Q K",
     // Reel 3
-    {"9", "J", "F", "10", "S", "9", "10", "9", "K", "Q", "9", "10", "S", "10", "J", "F", "10", "S", "J", "B", "J", "10", "Q", "R", "J", "R", "Q", "J", "9", "Q", "F", "B", "10", "B", "K", "J", "10", "F", "K", "F", "J", "F", "R", "10", "F", "R", "W", "J", "10", "J", "F", "9", "J", "9", "10", "J", "F", "9", "10"},
+    "9 J F 10 S 9 10 9 K Q 9 10 S 10 J F 10 S J B J 10 Q R J R Q J 9 Q F B 10 B K J 10 F K F J F R 10 F R W J 10 J F 9 J 9 10 J F 9 10",
     // Reel 4
-    {"9", "S", "10", "9", "Q", "J", "S", "Q", "K", "9", "B", "10", "Q", "S", "J", "10", "F", "J", "9", "J", "Q", "J", "R", "Q", "10", "Q", "J", "9", "Q", "J", "9", "Q", "W", "W", "W", "K", "F", "9", "Q", "S", "B", "Q", "10", "J", "K", "R", "10", "B", "J", "Q", "9", "K", "W", "W", "W", "B", "9", "S", "9", "K", "J"},
+    "9 S 10 9 Q J S Q K 9 B 10 Q S J 10 F J 9 J Q J R Q 10 Q J 9 Q J 9 Q W W W K F 9 Q S B Q 10 J K R 10 B J Q 9 K W W W B 9 S 9 K J",
     // Reel 5
-    {"9", "K", "B", "S", "10", "B", "K", "F", "S", "Q", "B", "Q", "J", "K", "W", "F", "Q", "R", "Q", "K", "10", "Q", "F", "9", "F", "B", "K", "B", "S", "10", "J", "K", "B", "10", "J", "B", "R", "B", "S", "F", "K", "F", "B", "F", "K", "10", "B", "Q", "W", "F", "Q", "W", "J", "B", "S", "F", "K", "Q", "K", "F", "S"}};
+    "9 K B S 10 B K F S Q B Q J K W F Q R Q K 10 Q F 9 F B K B S 10 J K B 10 J B R B S F K F B F K 10 B Q W F Q W J B S F K Q K F S"};
+
+// 單一符號字串 → 符號碼；未知符號於編譯期即報錯
+static constexpr uint8_t symCode(const char *t, int n)
+{
+    if (n == 2 && t[0] == '1' && t[1] == '0')
+        return S10;
+    if (n == 1)
+        switch (t[0])
+        {
+        case '9':
+            return S9;
+        case 'J':
+            return SJ;
+        case 'Q':
+            return SQ;
+        case 'K':
+            return SK;
+        case 'R':
+            return SR;
+        case 'F':
+            return SF;
+        case 'B':
+            return SB;
+        case 'W':
+            return SW;
+        case 'S':
+            return SS;
+        }
+    throw logic_error("unknown symbol in reel strip");
+}
+
+static constexpr ReelSet parseReels(const char *const (&src)[5])
+{
+    ReelSet R{};
+    for (int r = 0; r < 5; r++)
+    {
+        const char *p = src[r];
+        int L = 0;
+        while (*p)
+        {
+            while (*p == ' ')
+                p++;
+            if (!*p)
+                break;
+            int n = 0;
+            while (p[n] && p[n] != ' ')
+                n++;
+            if (L >= MAX_STRIP)
+                throw logic_error("reel strip longer than MAX_STRIP");
+            R.sym[r][L++] = symCode(p, n);
+            p += n;
+        }
+        R.len[r] = L;
+        R.sym[r][L] = R.sym[r][0];
+        R.sym[r][L + 1] = R.sym[r][1];
+    }
+    return R;
+}
+
+static constexpr ReelSet reelsMG = parseReels(reelsMGstr);
+static constexpr ReelSet reelsFG = parseReels(reelsFGstr);
+
 /**************
- * 啟動時轉碼：string → uint8_t
+ * 遊戲定義：輪帶、賠率表、線圖、FG 倍率/轉數與大獎分層門檻
+ * builtinGameDef() 取自上方編譯期資料；--game FILE 由文字設定檔載入（未給的鍵沿用內建值），
+ * 啟動時編成 Game（輪帶/賠率/位元盤/列 ID 表），熱路徑只讀 Game 內的扁平表
+ * 固定不變：符號集、5×3 視窗、25 線、3+S 觸發；單軸最長 MAX_STRIP 格
  **************/
-static uint8_t symCode(const string &s)
+struct GameDef
 {
-    if (s == "9")
-        return S9;
-    if (s == "10")
-        return S10;
-    if (s == "J")
-        return SJ;
-    if (s == "Q")
-        return SQ;
-    if (s == "K")
-        return SK;
-    if (s == "R")
-        return SR;
-    if (s == "F")
-        return SF;
-    if (s == "B")
-        return SB;
-    if (s == "W")
-        return SW;
-    if (s == "S")
-        return SS;
-    throw runtime_error("unknown symbol: " + s);
-}
-static vector<vector<uint8_t>> packReels(const vector<vector<string>> &src)
-{
-    vector<vector<uint8_t>> dst;
-    dst.reserve(src.size());
-    for (const auto &col : src)
-    {
-        vector<uint8_t> v;
-        v.reserve(col.size());
-        for (const auto &t : col)
-            v.push_back(symCode(t));
-        dst.push_back(move(v));
-    }
-    return dst;
-}
-static vector<vector<uint8_t>> reelsMG, reelsFG;
+    string name = "builtin";
+    bool builtin = true; // 內建定義（--exact / 報表才與 excelRTP 比對）
+    ReelSet reels[2];    // [MG]、[FG]
+    PayTable pay[2];
+    LineSet lines = builtinLines;
+    bool linesBuiltin = true;                            // 線圖與內建相同：scalar 走編譯期展開
+    int fgMul[6] = {0, 0, 0, 10, 50, 100};               // 依觸發時 S 數（≥5 取 [5]；整數，FG 贏分才是整數單位）
+    int fgSpins = 5;                                     // 觸發/再觸發給的轉數（亦為全空批次的批次長度）
+    double tierEdge[6] = {20, 60, 100, 300, 500, 1000}; // Big/Mega/Super/Holy/Jumbo/Jojo（×bet）
+};
+
+static GameDef builtinGameDef()
+{
+    GameDef d;
+    d.reels[MG] = reelsMG;
+    d.reels[FG] = reelsFG;
+    d.pay[MG] = payMG;
+    d.pay[FG] = payFG;
+    return d;
+}
+
+// 單軸字串 → 輪帶一列（尾端補開頭 2 格）；執行期版本的 parseReels
+static void parseStrip(const vector<string> &toks, ReelSet &R, int r)
+{
+    if (toks.size() < 3 || toks.size() > (size_t)MAX_STRIP)
+        throw runtime_error("輪帶長度須介於 3 與 " + to_string(MAX_STRIP));
+    int L = 0;
+    for (const string &t : toks)
+    {
+        try
+        {
+            R.sym[r][L++] = symCode(t.c_str(), (int)t.size());
+        }
+        catch (const logic_error &)
+        {
+            throw runtime_error("未知符號 " + t);
+        }
+    }
+    R.len[r] = L;
+    R.sym[r][L] = R.sym[r][0];
+    R.sym[r][L + 1] = R.sym[r][1];
+}
+
+/* 設定檔格式（一行一鍵，# 起為註解）：
+ *   name      變體名稱
+ *   mg_reel1 … mg_reel5 / fg_reel1 … fg_reel5   符號以空白分隔（9 10 J Q K R F B W S）
+ *   mg_pay / fg_pay  符號 3連 4連 5連（非負整數，單位 = 1 線注）
+ *   line      r1 r2 r3 r4 r5（0=上 1=中 2=下；有給就須剛好 25 行，取代內建線圖）
+ *   fg_mul    3S 4S 5S 倍率（非負整數）
+ *   fg_spins  觸發/再觸發轉數
+ *   tiers     Big Mega Super Holy Jumbo Jojo 門檻（×bet）
+ */
+// base：未出現的鍵沿用此定義（--sweep 變體以基準遊戲為底，只需寫差異）
+static inline GameDef loadGameDef(const string &path, const GameDef &base = builtinGameDef())
+{
+    ifstream in(path);
+    if (!in)
+        throw runtime_error("無法開啟遊戲設定 " + path);
+    GameDef d = base;
+    d.name = path;
+    d.builtin = false;
+    vector<array<uint8_t, 5>> lineRows;
+    string text;
+    for (int ln = 1; getline(in, text); ln++)
+    {
+        text = text.substr(0, text.find('#'));
+        istringstream ss(text);
+        string key;
+        if (!(ss >> key))
+            continue;
+        vector<string> toks;
+        for (string t; ss >> t;)
+            toks.push_back(t);
+        auto nums = [&](size_t n)
+        {
+            if (toks.size() != n)
+                throw runtime_error(key + " 需要 " + to_string(n) + " 個數值");
+            vector<double> v;
+            for (const string &t : toks)
+                v.push_back(stod(t));
+            return v;
+        };
+        // 非負整數：fg_spins，以及賠率與倍率（贏分以整數線注單位累加）
+        auto toInt = [&](const string &t)
+        {
+            double v = stod(t);
+            if (v < 0 || v > 1e9 || v != floor(v))
+                throw runtime_error(key + " 須為非負整數：" + t);
+            return (int)v;
+        };
+        try
+        {
+            if (key == "name")
+                d.name = toks.empty() ? path : toks[0];
+            else if ((key.rfind("mg_reel", 0) == 0 || key.rfind("fg_reel", 0) == 0) && key.size() == 8 &&
+                     key[7] >= '1' && key[7] <= '5')
+                parseStrip(toks, d.reels[key[0] == 'm' ? MG : FG], key[7] - '1');
+            else if (key == "mg_pay" || key == "fg_pay")
+            {
+                if (toks.size() != 4)
+                    throw runtime_error(key + " 格式為 符號 3連 4連 5連");
+                uint8_t sym = symCode(toks[0].c_str(), (int)toks[0].size());
+                if (sym == SW || sym == SS)
+                    throw runtime_error("W/S 不可有線獎賠率");
+                for (int k = 0; k < 3; k++)
+                    d.pay[key[0] == 'm' ? MG : FG][sym][k] = toInt(toks[k + 1]);
+            }
+            else if (key == "line")
+            {
+                auto v = nums(5);
+                array<uint8_t, 5> row{};
+                for (int r = 0; r < 5; r++)
+                {
+                    if (v[r] < 0 || v[r] > 2)
+                        throw runtime_error("線圖列號須為 0..2");
+                    row[r] = (uint8_t)v[r];
+                }
+                lineRows.push_back(row);
+            }
+            else if (key == "fg_mul")
+            {
+                if (toks.size() != 3)
+                    throw runtime_error("fg_mul 需要 3 個數值");
+                for (int k = 0; k < 3; k++)
+                    d.fgMul[3 + k] = toInt(toks[(size_t)k]);
+            }
+            else if (key == "fg_spins")
+            {
+                if (toks.size() != 1)
+                    throw runtime_error("fg_spins 需要 1 個數值");
+                d.fgSpins = toInt(toks[0]);
+                if (d.fgSpins <= 0)
+                    throw runtime_error("fg_spins 必須為正數");
+            }
+            else if (key == "tiers")
+            {
+                auto v = nums(6);
+                for (int k = 0; k < 6; k++)
+                    d.tierEdge[k] = v[k];
+            }
+            else
+                throw runtime_error("未知鍵 " + key);
+        }
+        catch (const logic_error &e) // stod / symCode
+        {
+            throw runtime_error(path + ":" + to_string(ln) + ": " + key + " 格式錯誤（" + e.what() + "）");
+        }
+        catch (const runtime_error &e)
+        {
+            throw runtime_error(path + ":" + to_string(ln) + ": " + e.what());
+        }
+    }
+    if (!lineRows.empty())
+    {
+        if (lineRows.size() != (size_t)numLines)
+            throw runtime_error(path + ": line 須剛好 " + to_string(numLines) + " 行");
+        copy(lineRows.begin(), lineRows.end(), d.lines.begin());
+        d.linesBuiltin = d.lines == builtinLines;
+    }
+    for (int m = 0; m < 2; m++)
+        for (int k = 0; k < d.reels[m].len[0]; k++)
+            if (d.reels[m].sym[0][k] == SW) // 全 W 線在 linePay 無定義
+                throw runtime_error(path + ": 第 1 軸不可有 W");
+    return d;
+}
+
+/**************
+ * 亂數產生器（--rng 選擇；spinWindow / playFG / worker 以 template 參數接收）
+ * 皆提供 uint64_t operator()()；停點以 Lemire multiply-shift 取 [0, L) 無偏整數，取代 rng() % L
+ **************/
+enum class RngKind : uint8_t
+{
+    MT,       // std::mt19937_64（原本的產生器）
+    Xoshiro,  // xoshiro256++
+    SplitMix, // SplitMix64
+    Philox    // Philox4x32-10（counter-based）
+};
+#ifndef SLOT_NO_MAIN
+static RngKind rngKind = RngKind::MT; // --rng（命令列）
+#endif
+
+static inline uint64_t splitmix64(uint64_t &x)
+{
+    uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+struct Mt64
+{
+    static constexpr const char *name = "mt19937_64";
+    mt19937_64 g;
+    explicit Mt64(uint64_t seed) : g(seed) {}
+    inline uint64_t operator()() { return g(); }
+};
+
+struct Xoshiro256pp
+{
+    static constexpr const char *name = "xoshiro256++";
+    uint64_t s[4];
+    explicit Xoshiro256pp(uint64_t seed)
+    {
+        for (auto &v : s) // 官方建議：以 SplitMix64 展開種子
+            v = splitmix64(seed);
+    }
+    static inline uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+    inline uint64_t operator()()
+    {
+        const uint64_t result = rotl(s[0] + s[3], 23) + s[0];
+        const uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+};
+
+struct SplitMix64
+{
+    static constexpr const char *name = "splitmix64";
+    uint64_t x;
+    explicit SplitMix64(uint64_t seed) : x(seed) {}
+    inline uint64_t operator()() { return splitmix64(x); }
+};
+
+// Philox4x32-10（Salmon et al. 2011）：輸出 = 對 (counter, key) 做 10 輪 bijection，每個 counter 產 2 個 uint64
+struct Philox4x32
+{
+    static constexpr const char *name = "philox4x32-10";
+    uint32_t ctr[4] = {}, key[2];
+    uint64_t buf[2] = {};
+    int idx = 2;
+    explicit Philox4x32(uint64_t seed) : key{(uint32_t)seed, (uint32_t)(seed >> 32)} {}
+    inline void refill()
+    {
+        uint32_t c[4] = {ctr[0], ctr[1], ctr[2], ctr[3]}, k[2] = {key[0], key[1]};
+        for (int round = 0; round < 10; round++)
+        {
+            const uint64_t p0 = (uint64_t)0xD2511F53u * c[0], p1 = (uint64_t)0xCD9E8D57u * c[2];
+            const uint32_t n0 = (uint32_t)(p1 >> 32) ^ c[1] ^ k[0], n2 = (uint32_t)(p0 >> 32) ^ c[3] ^ k[1];
+            c[0] = n0;
+            c[1] = (uint32_t)p1;
+            c[2] = n2;
+            c[3] = (uint32_t)p0;
+            k[0] += 0x9E3779B9u;
+            k[1] += 0xBB67AE85u;
+        }
+        buf[0] = ((uint64_t)c[0] << 32) | c[1];
+        buf[1] = ((uint64_t)c[2] << 32) | c[3];
+        if (++ctr[0] == 0) // 低 64 位為計數、高 64 位為子流編號（makeStream）
+            ++ctr[1];
+        idx = 0;
+    }
+    inline uint64_t operator()()
+    {
+        if (idx == 2)
+            refill();
+        return buf[idx++];
+    }
+};
+
+#ifndef SLOT_NO_MAIN
+static const char *rngName(RngKind k)
+{
+    switch (k)
+    {
+    case RngKind::Xoshiro:
+        return Xoshiro256pp::name;
+    case RngKind::SplitMix:
+        return SplitMix64::name;
+    case RngKind::Philox:
+        return Philox4x32::name;
+    default:
+        return Mt64::name;
+    }
+}
+#endif
+
+// 依 rngKind 呼叫 f(RngTag<R>{})，讓各模式取得具體型別 R 後實例化 template
+template <class R>
+struct RngTag
+{
+    using type = R;
+};
+template <class F>
+static void withRng(RngKind k, F &&f)
+{
+    switch (k)
+    {
+    case RngKind::Xoshiro:
+        f(RngTag<Xoshiro256pp>{});
+        break;
+    case RngKind::SplitMix:
+        f(RngTag<SplitMix64>{});
+        break;
+    case RngKind::Philox:
+        f(RngTag<Philox4x32>{});
+        break;
+    default:
+        f(RngTag<Mt64>{});
+        break;
+    }
+}
+
+// 由 (種子, 子流編號) 導出子流種子
+static inline uint64_t streamSeed(uint64_t seed, uint64_t stream)
+{
+    uint64_t x = seed ^ (stream * 0xD1B54A32D192ED03ULL);
+    splitmix64(x);
+    return splitmix64(x);
+}
+
+// 第 stream 條子流：Philox 直接以 (key = 種子, counter 高 64 位 = 子流) 切出互不重疊的計數區段；
+// 其餘產生器以雜湊後的子流種子初始化
+template <class Rng>
+static inline Rng makeStream(uint64_t seed, uint64_t stream)
+{
+    if constexpr (is_same<Rng, Philox4x32>::value)
+    {
+        Philox4x32 r(seed);
+        r.ctr[2] = (uint32_t)stream;
+        r.ctr[3] = (uint32_t)(stream >> 32);
+        return r;
+    }
+    else
+        return Rng(streamSeed(seed, stream));
+}
+
+// [0, L) 無偏整數（Lemire 2019）：取高 32 位乘 L，低位落在拒絕區才重抽（機率 < L/2^32）
+template <class Rng>
+static inline uint32_t boundedRand(Rng &rng, uint32_t L)
+{
+    uint64_t m = (uint64_t)(uint32_t)(rng() >> 32) * L;
+    uint32_t lo = (uint32_t)m;
+    if (lo < L)
+    {
+        const uint32_t t = (0u - L) % L;
+        while (lo < t)
+        {
+            m = (uint64_t)(uint32_t)(rng() >> 32) * L;
+            lo = (uint32_t)m;
+        }
+    }
+    return (uint32_t)(m >> 32);
+}
 
 /**************
  * 轉窗（5×3 視窗；每把覆寫；各worker各自持有）
@@ -217,27 +733,25 @@ struct Window5x3
     uint8_t c[5][3];
 };
 
-// 隨機停點 → 視窗取 stop, stop+1, stop+2（環迴）
-static inline void spinWindow(mt19937_64 &rng,
-                              const vector<vector<uint8_t>> &reels,
-                              Window5x3 *w)
+// 隨機停點 → 視窗取 stop, stop+1, stop+2（輪帶已補齊，免環迴取模）
+// 5 軸以 fold expression 於編譯期展開；逗號運算子保證依軸序抽亂數
+template <GameMode M, class Rng, size_t... R>
+static inline void spinWindowImpl(const GameDef &d, Rng &rng, Window5x3 *w, index_sequence<R...>)
 {
-    for (int r = 0; r < 5; r++)
-    {
-        int L = (int)reels[r].size();
-        int stop = (int)(rng() % L);
-        w->c[r][0] = reels[r][stop];
-        w->c[r][1] = reels[r][(stop + 1) % L];
-        w->c[r][2] = reels[r][(stop + 2) % L];
-    }
+    const ReelSet &reels = d.reels[M];
+    ((memcpy(w->c[R], &reels.sym[R][boundedRand(rng, (uint32_t)reels.len[R])], 3)), ...);
+}
+template <GameMode M, class Rng>
+static inline void spinWindow(const GameDef &d, Rng &rng, Window5x3 *w)
+{
+    spinWindowImpl<M>(d, rng, w, make_index_sequence<5>{});
 }
 
 /**************
  * 線獎：左到右；W 可代；S 斷線
- * 回傳該線倍率（未乘線注）
+ * 回傳該線倍率（線注單位）
  **************/
-static inline double linePay(const Window5x3 *w, const array<uint8_t, 5> &line,
-                             const array<array<double, 3>, NumSymbols> *pay)
+static inline int linePay(const PayTable &pay, const Window5x3 *w, const array<uint8_t, 5> &line)
 {
     // 找到第一個「非 W 非 S」作為目標符號
     uint8_t target = 255;
@@ -263,17 +777,142 @@ static inline double linePay(const Window5x3 *w, const array<uint8_t, 5> &line,
             break;
     }
     if (cnt >= 3)
-        return (*pay)[target][cnt - 3];
-    return 0.0;
+        return pay[target][cnt - 3];
+    return 0;
+}
+
+/**************
+ * 逐符號 / 逐線 RTP 貢獻（--breakdown）
+ * 以 template 策略接入：NoProbe 時所有 if constexpr 分支不存在，預設路徑不多一條指令；
+ * LineProbe 於每個視窗（MG 與每轉 FG）以 lineHit 逐線重算出 (符號, 連線數, 是否含 W)，
+ * 把乘上 FG 觸發倍率的贏分（整數線注單位）累加到所指的 LineBreakdown；
+ * 該累加器只在 LineProbe 實例中配置（每 worker 本塊一份，隨 Tally 交給 ChunkLedger），Stats 不含它
+ **************/
+struct LineHit
+{
+    uint8_t sym; // 目標符號
+    uint8_t len; // 3/4/5；0 = 無獎
+    bool wild;   // 連線中有 W 代替
+};
+
+// 與 linePay 同規則，另回傳連線組成
+static inline LineHit lineHit(const Window5x3 *w, const array<uint8_t, 5> &line)
+{
+    uint8_t target = 255;
+    for (int r = 0; r < 5; r++)
+    {
+        uint8_t s = w->c[r][line[r]];
+        if (s != SW && s != SS)
+        {
+            target = s;
+            break;
+        }
+    }
+    int cnt = 0;
+    bool wild = false;
+    for (int r = 0; r < 5; r++)
+    {
+        uint8_t s = w->c[r][line[r]];
+        if (s == SS || (s != SW && s != target))
+            break;
+        wild = wild || s == SW;
+        cnt++;
+    }
+    return {target, (uint8_t)(cnt >= 3 ? cnt : 0), wild};
 }
 
-// 25 線加總（未乘線注）
-static inline double evalAllLines(const Window5x3 *w,
-                                  const array<array<double, 3>, NumSymbols> *pay)
+struct LineBreakdown
+{
+    // [模式 MG/FG] 下的贏分（線注單位，已乘 FG 倍率）與中獎次數
+    long long symWin[2][NumSymbols][3] = {};
+    long long symHits[2][NumSymbols][3] = {};
+    long long lineWin[2][numLines] = {};
+    long long lineHits[2][numLines] = {};
+    long long kindWin[2][2] = {}; // [模式][0 = 全為本符號、1 = 含 W 代替]
+    long long kindHits[2][2] = {};
+
+    void merge(const LineBreakdown &o)
+    {
+        for (int m = 0; m < 2; m++)
+        {
+            for (int t = 0; t < NumSymbols; t++)
+                for (int k = 0; k < 3; k++)
+                {
+                    symWin[m][t][k] += o.symWin[m][t][k];
+                    symHits[m][t][k] += o.symHits[m][t][k];
+                }
+            for (int l = 0; l < numLines; l++)
+            {
+                lineWin[m][l] += o.lineWin[m][l];
+                lineHits[m][l] += o.lineHits[m][l];
+            }
+            for (int k = 0; k < 2; k++)
+            {
+                kindWin[m][k] += o.kindWin[m][k];
+                kindHits[m][k] += o.kindHits[m][k];
+            }
+        }
+    }
+};
+
+#ifndef SLOT_NO_MAIN
+static bool breakdownMode = false; // --breakdown：排程模式改用 LineProbe 實例
+#endif
+
+struct NoProbe
+{
+    static constexpr bool on = false;
+    NoProbe() = default;
+    NoProbe(LineBreakdown *, int) {}
+    NoProbe at(int) const { return {}; }
+};
+
+struct LineProbe
+{
+    static constexpr bool on = true;
+    LineBreakdown *br = nullptr;
+    int mul = 1; // FG 觸發倍率（MG 為 1）
+    LineProbe() = default;
+    LineProbe(LineBreakdown *b, int m) : br(b), mul(m) {}
+    LineProbe at(int m) const { return {br, m}; } // 同一累加器，改用觸發倍率 m（FG 串）
+
+    template <GameMode M>
+    void spin(const PayTable &pay, const LineSet &lines, const Window5x3 *w) const
+    {
+        for (int l = 0; l < numLines; l++)
+        {
+            LineHit h = lineHit(w, lines[(size_t)l]);
+            if (!h.len)
+                continue;
+            const long long win = (long long)pay[h.sym][h.len - 3] * mul;
+            if (win == 0)
+                continue;
+            br->symWin[M][h.sym][h.len - 3] += win;
+            br->symHits[M][h.sym][h.len - 3]++;
+            br->lineWin[M][l] += win;
+            br->lineHits[M][l]++;
+            br->kindWin[M][h.wild] += win;
+            br->kindHits[M][h.wild]++;
+        }
+    }
+};
+
+// 25 線加總（線注單位）；內建線圖為 constexpr，於編譯期展開成 25 個常數格位的 linePay，
+// 設定檔自訂線圖時逐線讀表
+template <size_t... I>
+static inline int evalBuiltinLines(const PayTable &pay, const Window5x3 *w, index_sequence<I...>)
+{
+    return (0 + ... + linePay(pay, w, builtinLines[I]));
+}
+template <GameMode M>
+static inline int evalAllLines(const GameDef &d, const Window5x3 *w)
 {
-    double sum = 0.0;
-    for (int i = 0; i < numLines; i++)
-        sum += linePay(w, lines[i], pay);
+    const PayTable &pay = d.pay[M];
+    if (d.linesBuiltin)
+        return evalBuiltinLines(pay, w, make_index_sequence<numLines>{});
+    int sum = 0;
+    for (const auto &line : d.lines)
+        sum += linePay(pay, w, line);
     return sum;
 }
 
@@ -293,69 +932,889 @@ static inline int countScatter(const Window5x3 *w)
     return c;
 }
 
-// 決定 FG 倍率（3S→×10、4S→×50、5S→×100）
-static inline double fgMulByScatter(int s)
+// 決定 FG 倍率（內建：3S→×10、4S→×50、5S→×100）
+static inline int fgMulByScatter(const GameDef &d, int s)
 {
-    if (s >= 5)
-        return 100;
-    if (s == 4)
-        return 50;
-    if (s == 3)
-        return 10;
-    return 0;
+    return d.fgMul[s >= 5 ? 5 : (s < 0 ? 0 : s)];
+}
+
+#ifndef SLOT_NO_MAIN
+// 報表標籤：「×10」與「Big  Win  (≥20×bet)  」（依遊戲定義的倍率/門檻）
+static string mulLabel(const GameDef &d, int s)
+{
+    ostringstream oss;
+    oss << "×" << fgMulByScatter(d, s);
+    return oss.str();
+}
+static string tierLabel(const GameDef &d, int i)
+{
+    static const char *name[] = {"Big  Win ", "Mega Win ", "Super Win", "Holy Win", "Jumbo Win", "Jojo Win "};
+    ostringstream oss;
+    oss << name[i] << " (≥" << d.tierEdge[i] << "×bet)";
+    string s = oss.str();
+    // 與原報表同寬（中文字元以 UTF-8 計，僅補到固定位元組數）
+    if (s.size() < 24)
+        s.append(24 - s.size(), ' ');
+    return s;
 }
+#endif
 
 /**************
- * 一整串 FG（5 轉起始；再觸發+5 轉，無上限）
- * 回傳：spins(總轉數)、base(FG 未乘倍率之總派彩)、
- *       retri(再觸發次數)、zeroBatches(5轉全空批次數)、totalBatches(總批次)
+ * 位元盤（bitboard）線獎核心
+ * 視窗 → 各符號 15-bit 佔用遮罩（格 = 軸*3+列），W 併入每個符號的遮罩；
+ * 每條線佔一個 32-bit lane，AVX2 一次算 8 線、SSE2 一次 4 線，回傳值與 evalAllLines 相同
+ * 執行期選擇：--kernel scalar|bitboard|sse2|avx2|auto
+ * auto：scalar（evalAllLines 依模式於編譯期展開 25 線後，實測快於 avx2；sse2/bitboard 更慢）
  **************/
-static tuple<int, double, int, int, int>
-playFG(mt19937_64 &rng, Window5x3 *w)
+enum class LineKernel : uint8_t
 {
-    int queue = 5;
-    int spins = 0, retri = 0, batchSpin = 0, zeroBatches = 0, totalBatches = 0;
-    double base = 0.0, batchWin = 0.0;
+    Scalar,   // 原 linePay 逐線
+    Bitboard, // 位元盤，純 C++
+    SSE2,
+    AVX2,
+    Auto
+};
+static LineKernel lineKernel = LineKernel::Auto;
 
-    while (queue > 0)
+static const char *kernelName(LineKernel k)
+{
+    switch (k)
     {
-        queue--;
-        spins++;
-        spinWindow(rng, reelsFG, w);
+    case LineKernel::Scalar:
+        return "scalar";
+    case LineKernel::Bitboard:
+        return "bitboard";
+    case LineKernel::SSE2:
+        return "sse2";
+    case LineKernel::AVX2:
+        return "avx2";
+    default:
+        return "auto";
+    }
+}
 
-        // 當轉派彩（FG 賠率表）×線注
-        double win = evalAllLines(w, &payFG) * betPerLine;
-        base += win;
+constexpr int LANES = 32; // 線數補齊到 32 lane（4×AVX2 / 8×SSE2）
+static_assert(numLines <= LANES, "bitboard kernel supports at most 32 lines");
 
-        // 3+S 再觸發 +5 轉
-        if (countScatter(w) >= 3)
-        {
-            queue += 5;
-            retri++;
-        }
+// 位元盤核心以 int32 lane 累加的賠率表（對齊後的副本）
+// cellBit[r][l]：第 l 線在第 r 軸所經格子的位元；補齊用的 lane 放第 31 位（視窗不會用到，永不匹配）
+struct BitboardPay
+{
+    alignas(32) int32_t pay[NumSymbols][3] = {};
+    alignas(32) uint32_t cellBit[5][LANES] = {};
+};
+static BitboardPay makeBitboardPay(const PayTable &pay, const LineSet &lines)
+{
+    BitboardPay bp{};
+    for (int r = 0; r < 5; r++)
+        for (int l = 0; l < LANES; l++)
+            bp.cellBit[r][l] = l < numLines ? 1u << (r * 3 + lines[l][r]) : 1u << 31;
+    for (int t = 0; t < NumSymbols; t++)
+        for (int k = 0; k < 3; k++)
+            bp.pay[t][k] = pay[t][k];
+    return bp;
+}
 
-        // 5 轉為一批次，統計全空批次
-        batchSpin++;
-        batchWin += win;
-        if (batchSpin == 5)
+static inline void buildMasks(const Window5x3 *w, uint32_t occ[NumSymbols])
+{
+    for (int t = 0; t < NumSymbols; t++)
+        occ[t] = 0;
+    for (int r = 0; r < 5; r++)
+        for (int k = 0; k < 3; k++)
+            occ[w->c[r][k]] |= 1u << (r * 3 + k);
+}
+
+// 符號 t 有機會在某線得獎：第 1 軸有 t 或 W，且視窗內有 t（目標符號 = 線上第一個非 W/S）
+static inline bool symbolCanPay(const uint32_t occ[NumSymbols], int t)
+{
+    return occ[t] && ((occ[t] | occ[SW]) & 7u);
+}
+
+static inline int linesBitboard(const uint32_t occ[NumSymbols], const BitboardPay &bp)
+{
+    const uint32_t ws = occ[SW] | occ[SS];
+    int sum = 0;
+    for (int t = 0; t < NumSymbols; t++)
+    {
+        if (t == SW || t == SS || !symbolCanPay(occ, t))
+            continue;
+        const uint32_t m = occ[t] | occ[SW];
+        for (int l = 0; l < numLines; l++)
         {
-            totalBatches++;
-            if (batchWin == 0.0)
-                zeroBatches++;
-            batchSpin = 0;
-            batchWin = 0.0;
+            bool alive = true, isTarget = false, prefixWS = true;
+            int len = 0;
+            for (int r = 0; r < 5; r++)
+            {
+                uint32_t b = bp.cellBit[r][l];
+                alive = alive && (m & b);
+                len += alive;
+                isTarget = isTarget || (prefixWS && (occ[t] & b));
+                prefixWS = prefixWS && (ws & b);
+            }
+            if (isTarget && len >= 3)
+                sum += bp.pay[t][len - 3];
         }
     }
-    if (batchSpin > 0)
+    return sum;
+}
+
+#ifdef SLOT_X86
+static inline int linesSSE2(const uint32_t occ[NumSymbols], const BitboardPay &bp)
+{
+    const __m128i ones = _mm_set1_epi32(-1), three = _mm_set1_epi32(3),
+                  four = _mm_set1_epi32(4), five = _mm_set1_epi32(5);
+    const __m128i WS = _mm_set1_epi32((int)(occ[SW] | occ[SS]));
+    __m128i acc = _mm_setzero_si128();
+    for (int t = 0; t < NumSymbols; t++)
     {
-        totalBatches++;
-        if (batchWin == 0.0)
-            zeroBatches++;
+        if (t == SW || t == SS || !symbolCanPay(occ, t))
+            continue;
+        const __m128i M = _mm_set1_epi32((int)(occ[t] | occ[SW])), T = _mm_set1_epi32((int)occ[t]);
+        const __m128i p3 = _mm_set1_epi32(bp.pay[t][0]), p4 = _mm_set1_epi32(bp.pay[t][1]),
+                      p5 = _mm_set1_epi32(bp.pay[t][2]);
+        for (int v = 0; v < LANES / 4; v++)
+        {
+            __m128i alive = ones, len = _mm_setzero_si128(), isT = _mm_setzero_si128(), pref = ones;
+            for (int r = 0; r < 5; r++)
+            {
+                __m128i b = _mm_load_si128((const __m128i *)&bp.cellBit[r][v * 4]);
+                alive = _mm_and_si128(alive, _mm_cmpeq_epi32(_mm_and_si128(M, b), b));
+                len = _mm_sub_epi32(len, alive);
+                isT = _mm_or_si128(isT, _mm_and_si128(pref, _mm_cmpeq_epi32(_mm_and_si128(T, b), b)));
+                pref = _mm_and_si128(pref, _mm_cmpeq_epi32(_mm_and_si128(WS, b), b));
+            }
+            __m128i pay = _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_cmpeq_epi32(len, three), p3),
+                                                    _mm_and_si128(_mm_cmpeq_epi32(len, four), p4)),
+                                       _mm_and_si128(_mm_cmpeq_epi32(len, five), p5));
+            acc = _mm_add_epi32(acc, _mm_and_si128(pay, isT));
+        }
     }
-    return {spins, base, retri, zeroBatches, totalBatches};
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0x4E));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0xB1));
+    return _mm_cvtsi128_si32(acc);
 }
 
-// ≥1000×獎項分佈細分
+SLOT_TARGET_AVX2 static int linesAVX2(const uint32_t occ[NumSymbols], const BitboardPay &bp)
+{
+    const __m256i ones = _mm256_set1_epi32(-1), three = _mm256_set1_epi32(3),
+                  four = _mm256_set1_epi32(4), five = _mm256_set1_epi32(5);
+    const __m256i WS = _mm256_set1_epi32((int)(occ[SW] | occ[SS]));
+    __m256i acc = _mm256_setzero_si256();
+    for (int t = 0; t < NumSymbols; t++)
+    {
+        if (t == SW || t == SS || !symbolCanPay(occ, t))
+            continue;
+        const __m256i M = _mm256_set1_epi32((int)(occ[t] | occ[SW])), T = _mm256_set1_epi32((int)occ[t]);
+        const __m256i p3 = _mm256_set1_epi32(bp.pay[t][0]), p4 = _mm256_set1_epi32(bp.pay[t][1]),
+                      p5 = _mm256_set1_epi32(bp.pay[t][2]);
+        for (int v = 0; v < LANES / 8; v++)
+        {
+            __m256i alive = ones, len = _mm256_setzero_si256(), isT = _mm256_setzero_si256(), pref = ones;
+            for (int r = 0; r < 5; r++)
+            {
+                __m256i b = _mm256_load_si256((const __m256i *)&bp.cellBit[r][v * 8]);
+                alive = _mm256_and_si256(alive, _mm256_cmpeq_epi32(_mm256_and_si256(M, b), b));
+                len = _mm256_sub_epi32(len, alive);
+                isT = _mm256_or_si256(isT, _mm256_and_si256(pref, _mm256_cmpeq_epi32(_mm256_and_si256(T, b), b)));
+                pref = _mm256_and_si256(pref, _mm256_cmpeq_epi32(_mm256_and_si256(WS, b), b));
+            }
+            __m256i pay = _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(_mm256_cmpeq_epi32(len, three), p3),
+                                                          _mm256_and_si256(_mm256_cmpeq_epi32(len, four), p4)),
+                                          _mm256_and_si256(_mm256_cmpeq_epi32(len, five), p5));
+            acc = _mm256_add_epi32(acc, _mm256_and_si256(pay, isT));
+        }
+    }
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+    return _mm_cvtsi128_si32(s);
+}
+#endif
+
+static bool cpuHasAVX2()
+{
+#ifdef SLOT_X86
+#ifdef _MSC_VER
+    int r[4];
+    __cpuid(r, 0);
+    if (r[0] < 7)
+        return false;
+    __cpuid(r, 1);
+    const bool osxsave = (r[2] >> 27) & 1, avx = (r[2] >> 28) & 1;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) // OS 需保存 YMM 狀態
+        return false;
+    __cpuidex(r, 7, 0);
+    return (r[1] >> 5) & 1;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+#else
+    return false;
+#endif
+}
+
+static bool kernelAvailable(LineKernel k)
+{
+    switch (k)
+    {
+    case LineKernel::Scalar:
+    case LineKernel::Bitboard:
+        return true;
+#ifdef SLOT_X86
+    case LineKernel::SSE2:
+        return true;
+    case LineKernel::AVX2:
+        return cpuHasAVX2();
+#endif
+    default:
+        return false;
+    }
+}
+
+// 25 線加總（線注單位）；依指定核心分派，各核心回傳值相同
+template <GameMode M>
+static inline int evalLines(LineKernel k, const GameDef &d, const BitboardPay &bp, const Window5x3 *w)
+{
+    if (k == LineKernel::Scalar)
+        return evalAllLines<M>(d, w);
+    uint32_t occ[NumSymbols];
+    buildMasks(w, occ);
+#ifdef SLOT_X86
+    if (k == LineKernel::AVX2)
+        return linesAVX2(occ, bp);
+    if (k == LineKernel::SSE2)
+        return linesSSE2(occ, bp);
+#endif
+    return linesBitboard(occ, bp);
+}
+
+// 模擬器熱路徑：依命令列選定的 lineKernel
+template <GameMode M>
+static inline int evalLines(const GameDef &d, const BitboardPay &bp, const Window5x3 *w)
+{
+    return evalLines<M>(lineKernel, d, bp, w);
+}
+
+// 自檢：隨機視窗上比對各核心與 scalar linePay 路徑（一半為任意符號、一半取自實際輪帶）
+// 回傳是否全部一致；verbose 時輸出各核心耗時
+static bool kernelSelfCheck(const GameDef &d, const BitboardPay bb[2], long long n, bool verbose)
+{
+    mt19937_64 rng(0x5EEDC0DEULL);
+    vector<Window5x3> ws((size_t)n);
+    for (long long i = 0; i < n; i++)
+    {
+        Window5x3 &w = ws[(size_t)i];
+        if (i & 1)
+        {
+            if (i & 2)
+                spinWindow<FG>(d, rng, &w);
+            else
+                spinWindow<MG>(d, rng, &w);
+        }
+        else
+            for (int r = 0; r < 5; r++)
+                for (int k = 0; k < 3; k++)
+                    w.c[r][k] = (uint8_t)(rng() % NumSymbols);
+        // 第 1 軸的 W 換成 S（與輪帶一致；全 W 線在 linePay 無定義）
+        for (int k = 0; k < 3; k++)
+            if (w.c[0][k] == SW)
+                w.c[0][k] = SS;
+    }
+
+    bool ok = true;
+    vector<int> ref[2];
+    for (int g = 0; g < 2; g++)
+    {
+        ref[g].resize((size_t)n);
+        for (long long i = 0; i < n; i++)
+            ref[g][(size_t)i] = g ? evalAllLines<FG>(d, &ws[(size_t)i]) : evalAllLines<MG>(d, &ws[(size_t)i]);
+    }
+    for (LineKernel k : {LineKernel::Scalar, LineKernel::Bitboard, LineKernel::SSE2, LineKernel::AVX2})
+    {
+        if (!kernelAvailable(k))
+        {
+            if (verbose)
+                std::fprintf(stderr, "[KERNEL] %-8s : 此 CPU/編譯不支援，略過\n", kernelName(k));
+            continue;
+        }
+        long long bad = 0, sink = 0;
+        auto t0 = chrono::steady_clock::now();
+        for (int g = 0; g < 2; g++)
+            for (long long i = 0; i < n; i++)
+            {
+                int v = g ? evalLines<FG>(k, d, bb[FG], &ws[(size_t)i]) : evalLines<MG>(k, d, bb[MG], &ws[(size_t)i]);
+                sink += v;
+                if (v != ref[g][(size_t)i])
+                    bad++;
+            }
+        double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - t0).count() / (2.0 * (double)n);
+        if (verbose)
+            std::fprintf(stderr, "[KERNEL] %-8s : %lld/%lld 不一致 | %.1f ns/視窗 (checksum %lld)\n",
+                         kernelName(k), bad, 2 * n, ns, sink);
+        ok = ok && bad == 0;
+    }
+    return ok;
+}
+
+/**************
+ * 列 ID 查表引擎（--engine column）
+ * 每軸停點 → 列 ID（該停點 3 格內容去重後的編號），視窗 = 5 個列 ID；
+ * 前 3 軸的列 ID 已決定每條線是否連滿 3 格（才可能得獎）與其目標符號，啟動時做成前綴表：
+ *   liveBits：每個前綴 1 bit，多數視窗在此即判定線獎為 0
+ *   prefix  ：活線遮罩 + 各線目標符號，只需再看第 4、5 軸
+ * 抽停點方式與 spinWindow 相同（boundedRand），同一亂數流下結果與視窗引擎一致
+ **************/
+enum class EvalEngine : uint8_t
+{
+    Window, // spinWindow + evalLines（依 lineKernel）
+    Column  // 列 ID + 前綴表
+};
+static EvalEngine evalEngine = EvalEngine::Window;
+
+static inline int ctz32(uint32_t x)
+{
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanForward(&i, x);
+    return (int)i;
+#else
+    return __builtin_ctz(x);
+#endif
+}
+
+struct SpinOutcome
+{
+    int line;    // 線獎總倍率（線注單位）
+    int scatter; // 視窗內 S 數
+};
+
+struct ColumnTables
+{
+    static constexpr uint8_t WILD_TARGET = 255; // 前 3 格皆 W：目標符號待第 4、5 軸決定（走 linePay）
+
+    struct Prefix
+    {
+        uint32_t live;               // 前 3 軸已連滿的線
+        uint8_t target[numLines];    // 各活線的目標符號
+    };
+
+    int L[5] = {};                         // 輪帶長度
+    int n[5] = {};                         // 各軸相異列數
+    vector<uint8_t> colOfStop[5];          // 停點 → 列 ID
+    vector<array<uint8_t, 3>> colSyms[5];  // 列 ID → 3 格符號
+    vector<uint8_t> colScatter[5];         // 列 ID → S 數
+    vector<uint64_t> liveBits;             // 前綴是否有活線
+    vector<Prefix> prefix;                 // 索引 (c0·n1 + c1)·n2 + c2
+    const PayTable *pay = nullptr;
+    const LineSet *lines = nullptr;
+
+    size_t bytes() const
+    {
+        size_t b = liveBits.size() * sizeof(uint64_t) + prefix.size() * sizeof(Prefix);
+        for (int r = 0; r < 5; r++)
+            b += colOfStop[r].size() + colSyms[r].size() * 3 + colScatter[r].size();
+        return b;
+    }
+
+    inline int lineWin(const uint8_t c[5]) const
+    {
+        size_t idx = ((size_t)c[0] * n[1] + c[1]) * n[2] + c[2];
+        if (!((liveBits[idx >> 6] >> (idx & 63)) & 1))
+            return 0;
+        const Prefix &p = prefix[idx];
+        const auto &s3 = colSyms[3][c[3]], &s4 = colSyms[4][c[4]];
+        int sum = 0;
+        for (uint32_t m = p.live; m; m &= m - 1)
+        {
+            int l = ctz32(m);
+            uint8_t t = p.target[l];
+            if (t == WILD_TARGET)
+            {
+                Window5x3 w{};
+                for (int r = 0; r < 5; r++)
+                    for (int k = 0; k < 3; k++)
+                        w.c[r][k] = colSyms[r][c[r]][k];
+                sum += linePay(*pay, &w, (*lines)[l]);
+                continue;
+            }
+            int cnt = 3;
+            uint8_t a = s3[(*lines)[l][3]];
+            if (a == t || a == SW)
+            {
+                cnt = 4;
+                uint8_t b = s4[(*lines)[l][4]];
+                if (b == t || b == SW)
+                    cnt = 5;
+            }
+            sum += (*pay)[t][cnt - 3];
+        }
+        return sum;
+    }
+
+    template <class Rng>
+    inline SpinOutcome spin(Rng &rng) const
+    {
+        uint8_t c[5];
+        int sc = 0;
+        for (int r = 0; r < 5; r++)
+        {
+            c[r] = colOfStop[r][boundedRand(rng, (uint32_t)L[r])];
+            sc += colScatter[r][c[r]];
+        }
+        return {lineWin(c), sc};
+    }
+};
+
+// pay / lines 指向 d 內的表：d 須活得比回傳的 ColumnTables 久（Game 內以 unique_ptr 固定位址）
+static ColumnTables buildColumnTables(const GameDef &d, GameMode m)
+{
+    const ReelSet &R = d.reels[m];
+    const LineSet &lines = d.lines;
+    ColumnTables T;
+    T.pay = &d.pay[m];
+    T.lines = &d.lines;
+    for (int r = 0; r < 5; r++)
+    {
+        T.L[r] = R.len[r];
+        map<array<uint8_t, 3>, uint8_t> ids;
+        for (int stop = 0; stop < T.L[r]; stop++)
+        {
+            array<uint8_t, 3> col = {R.sym[r][stop], R.sym[r][stop + 1], R.sym[r][stop + 2]};
+            auto it = ids.find(col);
+            if (it == ids.end())
+            {
+                if (ids.size() >= 256)
+                    throw runtime_error("column engine: more than 256 distinct columns on a reel");
+                it = ids.emplace(col, (uint8_t)ids.size()).first;
+                T.colSyms[r].push_back(col);
+                T.colScatter[r].push_back((uint8_t)((col[0] == SS) + (col[1] == SS) + (col[2] == SS)));
+            }
+            T.colOfStop[r].push_back(it->second);
+        }
+        T.n[r] = (int)T.colSyms[r].size();
+    }
+
+    const size_t P = (size_t)T.n[0] * T.n[1] * T.n[2];
+    T.prefix.assign(P, ColumnTables::Prefix{});
+    T.liveBits.assign((P + 63) / 64, 0);
+    for (size_t idx = 0; idx < P; idx++)
+    {
+        const int c2 = (int)(idx % T.n[2]), c1 = (int)(idx / T.n[2] % T.n[1]), c0 = (int)(idx / T.n[2] / T.n[1]);
+        const array<uint8_t, 3> *cols[3] = {&T.colSyms[0][c0], &T.colSyms[1][c1], &T.colSyms[2][c2]};
+        ColumnTables::Prefix &p = T.prefix[idx];
+        for (int l = 0; l < numLines; l++)
+        {
+            // 與 linePay 同義：目標 = 第一個非 W/S；遇 S 斷，W 視為匹配
+            uint8_t target = ColumnTables::WILD_TARGET;
+            for (int r = 0; r < 3 && target == ColumnTables::WILD_TARGET; r++)
+            {
+                uint8_t s = (*cols[r])[lines[l][r]];
+                if (s != SW && s != SS)
+                    target = s;
+            }
+            int cnt = 0;
+            for (int r = 0; r < 3; r++)
+            {
+                uint8_t s = (*cols[r])[lines[l][r]];
+                if (s == SS || (s != SW && s != target))
+                    break;
+                cnt++;
+            }
+            if (cnt == 3)
+            {
+                p.live |= 1u << l;
+                p.target[l] = target;
+            }
+        }
+        if (p.live)
+            T.liveBits[idx >> 6] |= 1ULL << (idx & 63);
+    }
+    return T;
+}
+
+/**************
+ * FG 串快取（--fg-cache N）：預先模擬 N 串 FG，相同結果合併計數後建 Walker alias 表
+ * 觸發時改為 O(1) 抽一個 (spins, base, retri, zeroBatches, totalBatches)；
+ * 抽樣只用一個 64-bit 亂數：高 32 位定格、低 32 位與門檻比較決定取本格或其 alias
+ * 記憶體佈局即檔案佈局（FgCacheHeader + 結果 + 門檻 + alias），--fg-cache-file 可直接 mmap
+ **************/
+struct FgOutcome
+{
+    int64_t base; // 未乘倍率之總派彩（線注單位）
+    int32_t spins, retri, zeroBatches, totalBatches;
+};
+
+struct FgCache
+{
+    const FgOutcome *out = nullptr; // 依 base 遞增排序
+    const uint64_t *thresh = nullptr; // 取本格的門檻（0..2^32）
+    const uint32_t *alias = nullptr;
+    uint64_t n = 0;        // 相異結果數
+    uint64_t sessions = 0; // 建表樣本串數
+    vector<char> own;      // 自建或整檔讀入
+    void *map = nullptr;   // mmap 區（POSIX）
+    size_t mapLen = 0;
+
+    FgCache() = default;
+    FgCache(const FgCache &) = delete;
+    FgCache &operator=(const FgCache &) = delete;
+    ~FgCache()
+    {
+#if !defined(_WIN32)
+        if (map)
+            munmap(map, mapLen);
+#endif
+    }
+
+    template <class Rng>
+    tuple<int, long long, int, int, int> sample(Rng &rng) const
+    {
+        uint64_t x = rng();
+        uint64_t i = ((x >> 32) * n) >> 32;
+        if ((x & 0xffffffffULL) >= thresh[i])
+            i = alias[i];
+        const FgOutcome &o = out[i];
+        return {o.spins, o.base, o.retri, o.zeroBatches, o.totalBatches};
+    }
+};
+
+/**************
+ * 編譯後的遊戲：定義 + 熱路徑查表（位元盤賠率/線格位元、列 ID 表）
+ * 熱路徑一律以 const Game & 取表；多組設定可同時存在、交錯在同一執行緒池上跑
+ **************/
+struct Game
+{
+    GameDef def;
+    BitboardPay bb[2]; // [MG]、[FG]
+    ColumnTables col[2];
+    unique_ptr<FgCache> fgCache; // --fg-cache：非空時觸發改抽快取
+};
+#ifndef SLOT_NO_MAIN
+static vector<unique_ptr<Game>> games; // 依 --game 順序；未指定時只有內建一組
+static vector<string> gamePaths;        // --game FILE（可多次）
+static bool interleaveGames = false;    // --interleave：多組設定的塊交錯排程（預設依序）
+static vector<string> sweepPaths;       // --sweep FILE（可多次）：以 games[0] 為基準的變體
+#endif
+
+static inline unique_ptr<Game> compileGame(const GameDef &d)
+{
+    unique_ptr<Game> g(new Game);
+    g->def = d;
+    for (int m = 0; m < 2; m++)
+        g->bb[m] = makeBitboardPay(g->def.pay[m], g->def.lines);
+    if (evalEngine != EvalEngine::Column)
+        return g;
+
+    size_t total = 0;
+    const char *name[2] = {"MG", "FG"};
+    for (int m = 0; m < 2; m++)
+    {
+        ColumnTables &T = g->col[m];
+        T = buildColumnTables(g->def, (GameMode)m);
+        size_t live = 0;
+        for (uint64_t b : T.liveBits)
+            live += (size_t)bitset<64>(b).count();
+        std::fprintf(stderr, "[ENGINE] column %s %s | 列數 %d/%d/%d/%d/%d | 前綴 %zu 項（有活線 %.1f%%）| %.2f MB\n",
+                     g->def.name.c_str(), name[m], T.n[0], T.n[1], T.n[2], T.n[3], T.n[4], T.prefix.size(),
+                     100.0 * (double)live / (double)T.prefix.size(), (double)T.bytes() / (1024.0 * 1024.0));
+        total += T.bytes();
+    }
+    std::fprintf(stderr, "[ENGINE] column 查表合計 %.2f MB\n", (double)total / (1024.0 * 1024.0));
+    return g;
+}
+
+// 決定實際使用的核心（auto/不支援時退回），並於非 scalar 時先以該遊戲跑一次自檢；不讀寫任何全域設定
+static LineKernel pickKernel(LineKernel k, const Game &g)
+{
+    if (k == LineKernel::Auto)
+        k = LineKernel::Scalar;
+    else if (!kernelAvailable(k))
+    {
+        std::fprintf(stderr, "[KERNEL] %s 不支援，改用 bitboard\n", kernelName(k));
+        k = LineKernel::Bitboard;
+    }
+    if (k != LineKernel::Scalar && !kernelSelfCheck(g.def, g.bb, 20000, false))
+    {
+        std::fprintf(stderr, "[KERNEL] %s 自檢與 linePay 不一致，改用 scalar\n", kernelName(k));
+        k = LineKernel::Scalar;
+    }
+    return k;
+}
+
+// 一轉：抽停點 → 線獎總倍率 + S 數（依 evalEngine）
+template <GameMode M, class Rng>
+static inline SpinOutcome spinEval(const Game &g, Rng &rng, Window5x3 *w)
+{
+    if (evalEngine == EvalEngine::Column)
+        return g.col[M].spin(rng);
+    spinWindow<M>(g.def, rng, w);
+    return {evalLines<M>(g.def, g.bb[M], w), countScatter(w)};
+}
+
+// x86 時間戳計數器（參考時脈，非核心時脈）；其他平台回傳 0
+static inline uint64_t readTsc()
+{
+#if defined(SLOT_X86) && defined(_MSC_VER)
+    return __rdtsc();
+#elif defined(SLOT_X86) && (defined(__GNUC__) || defined(__clang__))
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**************
+ * 分段剖析（編譯期選項 -DSLOT_PROFILE；未定義時以下與各插樁點完全不編入，可直接與一般建置比吞吐量）
+ *   每條 worker 執行緒一份 profLocal：塊總計時、FG 串計時（MG 路徑 = 塊 − FG，含統計記帳）、
+ *   FG 串長（依再觸發次數）與再觸發代數分佈、最長一串；worker 結束時交回 WorkerReport，排程結束合併輸出
+ *   計時單位：x86 為 TSC，其他平台為 steady_clock ns；每串 FG 只讀兩次，MG 熱迴圈內不讀
+ *   代數：最初 5 轉為第 0 代，第 k 代轉出的再觸發轉數屬第 k+1 代（FIFO 消化，與 playFG 的佇列等價）
+ **************/
+#ifdef SLOT_PROFILE
+struct PhaseProfile
+{
+    static constexpr int RETRI_BINS = 64; // 再觸發 0..62 次，最後一格 ≥ 63
+    static constexpr int DEPTH_BINS = 32; // 代數 0..30，最後一格 ≥ 31
+
+    uint64_t chunkTicks = 0, fgTicks = 0;
+    long long spins = 0, sessions = 0;
+    long long retriHist[RETRI_BINS] = {}, depthHist[DEPTH_BINS] = {};
+    long long depthKnown = 0; // --fg-cache 抽樣的串沒有代數資訊
+    int longest = 0;          // 最長一串 FG 轉數
+
+    void merge(const PhaseProfile &p)
+    {
+        chunkTicks += p.chunkTicks;
+        fgTicks += p.fgTicks;
+        spins += p.spins;
+        sessions += p.sessions;
+        for (int i = 0; i < RETRI_BINS; i++)
+            retriHist[i] += p.retriHist[i];
+        for (int i = 0; i < DEPTH_BINS; i++)
+            depthHist[i] += p.depthHist[i];
+        depthKnown += p.depthKnown;
+        longest = max(longest, p.longest);
+    }
+};
+
+static thread_local PhaseProfile profLocal;
+static thread_local int profDepth = -1; // playFG 寫入最近一串的代數
+
+static inline uint64_t profTicks()
+{
+#ifdef SLOT_X86
+    return readTsc();
+#else
+    return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+static inline void profRecordFG(int spins, int retri, uint64_t ticks)
+{
+    PhaseProfile &p = profLocal;
+    p.fgTicks += ticks;
+    p.sessions++;
+    p.retriHist[min(retri, PhaseProfile::RETRI_BINS - 1)]++;
+    p.longest = max(p.longest, spins);
+    if (profDepth >= 0)
+    {
+        p.depthHist[min(profDepth, PhaseProfile::DEPTH_BINS - 1)]++;
+        p.depthKnown++;
+    }
+}
+#endif
+
+/**************
+ * 一整串 FG（5 轉起始；再觸發+5 轉，無上限）
+ * 回傳：spins(總轉數)、base(FG 未乘倍率之總派彩，線注單位)、
+ *       retri(再觸發次數)、zeroBatches(5轉全空批次數)、totalBatches(總批次)
+ **************/
+template <class Probe = NoProbe, class Rng>
+static tuple<int, long long, int, int, int>
+playFG(const Game &g, Rng &rng, Window5x3 *w, Probe probe = Probe())
+{
+    const int grant = g.def.fgSpins; // 內建 5
+    int queue = grant;
+    int spins = 0, retri = 0, batchSpin = 0, zeroBatches = 0, totalBatches = 0;
+    long long base = 0, batchWin = 0;
+#ifdef SLOT_PROFILE
+    int genLeft = grant, genNext = 0, depth = 0;
+#endif
+
+    while (queue > 0)
+    {
+        queue--;
+        spins++;
+        SpinOutcome o = spinEval<FG>(g, rng, w);
+        if constexpr (Probe::on)
+            probe.template spin<FG>(g.def.pay[FG], g.def.lines, w);
+
+        // 當轉派彩（FG 賠率表，線注單位）
+        const int win = o.line;
+        base += win;
+
+        // 3+S 再觸發 +5 轉
+        if (o.scatter >= 3)
+        {
+            queue += grant;
+            retri++;
+#ifdef SLOT_PROFILE
+            genNext += grant;
+#endif
+        }
+#ifdef SLOT_PROFILE
+        if (--genLeft == 0 && genNext > 0)
+        {
+            depth++;
+            genLeft = genNext;
+            genNext = 0;
+        }
+#endif
+
+        // 5 轉為一批次，統計全空批次
+        batchSpin++;
+        batchWin += win;
+        if (batchSpin == grant)
+        {
+            totalBatches++;
+            if (batchWin == 0)
+                zeroBatches++;
+            batchSpin = 0;
+            batchWin = 0;
+        }
+    }
+    if (batchSpin > 0)
+    {
+        totalBatches++;
+        if (batchWin == 0)
+            zeroBatches++;
+    }
+#ifdef SLOT_PROFILE
+    profDepth = depth;
+#endif
+    return {spins, base, retri, zeroBatches, totalBatches};
+}
+
+// 一整串 FG：有快取時以 alias 表 O(1) 抽樣，否則實跑 playFG（--breakdown 需逐轉視窗，不與快取併用）
+template <class Probe = NoProbe, class Rng>
+static inline tuple<int, long long, int, int, int> drawFG(const Game &g, Rng &rng, Window5x3 *w, Probe probe = Probe())
+{
+    if constexpr (!Probe::on)
+        if (g.fgCache)
+            return g.fgCache->sample(rng);
+    return playFG(g, rng, w, probe);
+}
+
+/**************
+ * 可嵌入引擎（SlotEngine）：與模擬器共用同一份輪帶、賠率表、spinWindow 取窗規則、evalLines 線獎核心與 FG 規則
+ * 遊戲伺服器在 #include 本檔前 #define SLOT_NO_MAIN 即可使用（模擬器、命令列參數與 main 皆不編入，-Wall -Wextra 無警告）：
+ *     unique_ptr<Game> g = compileGame(builtinGameDef()); SlotEngine E(*g); SpinRecord r; E.spin(rng, r);
+ * 線獎核心於建構時自選並存於實例（預設 auto；不讀命令列的 lineKernel）：SlotEngine E(*g, LineKernel::AVX2)
+ * spin() 為 const、不寫任何共享狀態、不配置記憶體：多執行緒共用同一實例，各自持有亂數流與 SpinRecord
+ * MG 與 FG 共用呼叫端的同一條亂數流；一律走視窗引擎以取得停點（FG 串快取只存結果，不使用）
+ **************/
+struct FgSpinRecord
+{
+    uint8_t stops[5]; // 輪帶索引（視窗為 stop..stop+2）
+    uint8_t scatter;  // 視窗內 S 數（≥3 再觸發）
+    int32_t win;      // 當轉線獎（線注單位，未乘觸發倍率）
+};
+
+struct SpinRecord
+{
+    static const int MAX_FG = 1024; // 逐轉明細容量；超出時只留前段（fgTruncated），各總計仍完整
+    uint8_t stops[5];
+    uint8_t scatter;
+    bool fgTruncated;
+    int32_t mgWin;    // MG 線獎（線注單位）
+    int32_t fgMul;    // 觸發倍率（0 = 未觸發）
+    int32_t fgSpins;  // FG 串總轉數
+    int32_t fgRetri;  // 再觸發次數
+    int64_t fgBase;   // FG 串未乘倍率之總派彩
+    int64_t totalWin; // mgWin + fgBase × fgMul（線注單位；× bet/line 即金額）
+    FgSpinRecord fg[MAX_FG];
+};
+
+class SlotEngine
+{
+    const Game &g;
+    LineKernel kernel; // 建構時已解析（不會是 Auto）
+
+    // 與 spinWindow 相同的抽取順序（依軸序各一次 boundedRand），另回傳停點
+    template <GameMode M, class Rng>
+    inline void draw(Rng &rng, uint8_t stops[5], Window5x3 *w) const
+    {
+        const ReelSet &reels = g.def.reels[M];
+        for (int r = 0; r < 5; r++)
+        {
+            const uint32_t s = boundedRand(rng, (uint32_t)reels.len[r]);
+            stops[r] = (uint8_t)s;
+            memcpy(w->c[r], &reels.sym[r][s], 3);
+        }
+    }
+
+public:
+    explicit SlotEngine(const Game &game, LineKernel k = LineKernel::Auto) : g(game), kernel(pickKernel(k, game)) {}
+    const GameDef &def() const { return g.def; }
+    LineKernel kernelUsed() const { return kernel; }
+
+    template <class Rng>
+    void spin(Rng &rng, SpinRecord &r) const
+    {
+        const GameDef &d = g.def;
+        Window5x3 w;
+        draw<MG>(rng, r.stops, &w);
+        r.mgWin = evalLines<MG>(kernel, d, g.bb[MG], &w);
+        r.scatter = (uint8_t)countScatter(&w);
+        r.fgMul = r.fgSpins = r.fgRetri = 0;
+        r.fgBase = 0;
+        if (r.scatter >= 3)
+        {
+            r.fgMul = fgMulByScatter(d, r.scatter);
+            FgSpinRecord spill;
+            for (int queue = d.fgSpins; queue > 0; queue--)
+            {
+                FgSpinRecord &f = r.fgSpins < SpinRecord::MAX_FG ? r.fg[r.fgSpins] : spill;
+                draw<FG>(rng, f.stops, &w);
+                f.win = evalLines<FG>(kernel, d, g.bb[FG], &w);
+                f.scatter = (uint8_t)countScatter(&w);
+                r.fgBase += f.win;
+                r.fgSpins++;
+                if (f.scatter >= 3)
+                {
+                    queue += d.fgSpins;
+                    r.fgRetri++;
+                }
+            }
+        }
+        r.fgTruncated = r.fgSpins > SpinRecord::MAX_FG;
+        r.totalWin = r.mgWin + r.fgBase * r.fgMul;
+    }
+};
+
+/**************
+ * 以下為模擬器/命令列程式（統計、排程、檢查點、報表、各模式與 main）
+ * 嵌入 SlotEngine 時（#define SLOT_NO_MAIN）整段不編入，嵌入端只取得上方的遊戲定義、亂數與引擎
+ **************/
+#ifndef SLOT_NO_MAIN
+
+// 載入並編譯所有遊戲（未給 --game 時為內建）；失敗時丟 runtime_error
+static void buildGames()
+{
+    games.clear();
+    if (gamePaths.empty())
+        games.push_back(compileGame(builtinGameDef()));
+    for (const string &path : gamePaths)
+        games.push_back(compileGame(loadGameDef(path)));
+    for (const string &path : sweepPaths)
+        games.push_back(compileGame(loadGameDef(path, games[0]->def)));
+}
+
+// 命令列：以第一組遊戲決定 lineKernel
+static void resolveKernel() { lineKernel = pickKernel(lineKernel, *games[0]); }
+
+// ≥1000×獎項分佈細分
 static const double HIGH_BIN_EDGES[] = {
     1000, 2000, 3000, 4000, 5000,
     6000, 7000, 8000, 9000, 10000,
@@ -364,273 +1823,4131 @@ static const double HIGH_BIN_EDGES[] = {
 static const int NUM_HIGH_BINS = sizeof(HIGH_BIN_EDGES) / sizeof(HIGH_BIN_EDGES[0]);
 
 /**************
- * 自訂統計（worker 本地先累計，最後匯總）
+ * 贏分分佈直方圖（HDR 式 log-linear，固定記憶體）
+ * 單位 ×bet；[0] = 0、[1] = (0, 2^MIN_EXP)、最後一格 = ≥ 2^MAX_EXP，其餘每個 2 的冪切 SUB 等寬格（相對寬度 ≤ 1/SUB）
+ * 取格只用 double 的指數與前 SUB_BITS 位尾數：一次位移、一次減法、兩次夾值，無迴圈無分支鏈
+ * 純整數計數，合併與順序無關
+ **************/
+struct WinHist
+{
+    static const int SUB_BITS = 5, SUB = 1 << SUB_BITS;
+    static const int MIN_EXP = -8, MAX_EXP = 18; // 1/256× ~ 262144×
+    static const int BUCKETS = (MAX_EXP - MIN_EXP) * SUB + 3;
+    uint64_t n[BUCKETS] = {};
+
+    static inline int index(double x)
+    {
+        if (!(x > 0))
+            return 0;
+        uint64_t b;
+        memcpy(&b, &x, sizeof(b));
+        long long k = (long long)(b >> (52 - SUB_BITS)) - ((long long)(1023 + MIN_EXP) << SUB_BITS) + 2;
+        return (int)min<long long>(max<long long>(k, 1), BUCKETS - 1);
+    }
+    inline void add(double x) { n[index(x)]++; }
+    void merge(const WinHist &o)
+    {
+        for (int i = 0; i < BUCKETS; i++)
+            n[i] += o.n[i];
+    }
+    // 第 i 格下緣（[0] 與 [1] 皆為 0）
+    static double lower(int i)
+    {
+        if (i <= 1)
+            return 0.0;
+        int k = i - 2;
+        return ldexp(1.0 + (double)(k % SUB) / SUB, MIN_EXP + k / SUB);
+    }
+    static double upper(int i)
+    {
+        return i == 0 ? 0.0 : (i == 1 ? ldexp(1.0, MIN_EXP) : (i == BUCKETS - 1 ? INFINITY : lower(i + 1)));
+    }
+    uint64_t total() const
+    {
+        uint64_t t = 0;
+        for (uint64_t v : n)
+            t += v;
+        return t;
+    }
+    // 第 q 分位（0..1）：落點格內線性內插
+    double quantile(double q) const
+    {
+        const uint64_t t = total();
+        if (t == 0)
+            return 0.0;
+        double target = q * (double)t, acc = 0;
+        for (int i = 0; i < BUCKETS; i++)
+        {
+            if (n[i] == 0)
+                continue;
+            if (acc + (double)n[i] >= target)
+            {
+                if (i == 0 || i == BUCKETS - 1)
+                    return lower(i);
+                return lower(i) + (upper(i) - lower(i)) * (target - acc) / (double)n[i];
+            }
+            acc += (double)n[i];
+        }
+        return lower(BUCKETS - 1);
+    }
+    // ≥ x 的計數（x 落在格內時依格內均勻分佈估計）
+    double countAtLeast(double x) const
+    {
+        double c = 0;
+        for (int i = BUCKETS - 1; i >= 0; i--)
+        {
+            double lo = lower(i), hi = upper(i);
+            if (i == 0 ? x <= 0 : lo >= x)
+                c += (double)n[i];
+            else if (i > 0 && hi > x && i < BUCKETS - 1)
+                c += (double)n[i] * (hi - x) / (hi - lo);
+        }
+        return c;
+    }
+};
+
+// 報表：分位數（%）與門檻（×bet）可由 --percentiles / --hist-tiers 改；--hist-csv 匯出整份直方圖
+static vector<double> reportPercentiles = {50, 90, 99, 99.9, 99.99, 99.999};
+static vector<double> reportTiers = {1, 2, 5, 10, 20, 50, 100, 500, 1000, 5000, 10000};
+static string histCsvPath;
+
+static vector<double> parseList(const string &s)
+{
+    vector<double> v;
+    stringstream ss(s);
+    for (string t; getline(ss, t, ',');)
+        if (!t.empty())
+            v.push_back(stod(t));
+    return v;
+}
+
+/**************
+ * 128-bit 無號整數（單把贏分平方和；MSVC 無 __int128，以兩個 64-bit 字組手動進位）
+ **************/
+struct U128
+{
+    uint64_t lo = 0, hi = 0;
+
+    void add(uint64_t v)
+    {
+        lo += v;
+        hi += lo < v;
+    }
+    void add(const U128 &o)
+    {
+        add(o.lo);
+        hi += o.hi;
+    }
+    // += v²：v < 2^32 時平方不溢位（絕大多數把），否則拆 32-bit 半字做 64×64 → 128
+    void addSquare(uint64_t v)
+    {
+        if ((v >> 32) == 0)
+        {
+            add(v * v);
+            return;
+        }
+        const uint64_t a = v >> 32, b = v & 0xffffffffULL;
+        const uint64_t ab = a * b, bb = b * b;
+        const uint64_t mid = ab << 33, low = bb + mid;
+        hi += a * a + (ab >> 31) + (low < bb);
+        add(low);
+    }
+    double toDouble() const { return (double)hi * 18446744073709551616.0 + (double)lo; }
+};
+
+/**************
+ * 自訂統計（worker 本地先累計，最後匯總）
+ * 贏分一律為整數線注單位（1 = 一線押注）：和為 int64、平方和為 128-bit，合併與順序無關且逐位元可重現；
+ * 金額（× betPerLine）與 RTP 只在報表換算
+ **************/
+struct Stats
+{
+    long long mainLineWinSum = 0; // 主遊戲線獎總和（線注單位）
+    long long freeGameWinSum = 0; // 所有 FG 派彩（已乘倍率，線注單位）
+    long long triggerCount = 0;   // 觸發 FG 次數（MG→FG）
+    long long retriggerCount = 0; // 再觸發次數（FG 內獲得 3+S）
+    long long totalFGSpins = 0;   // FG 實際總轉數
+    long long maxSingleSpin = 0;  // 單把最高贏分（MG+FG，線注單位）
+    long long deadSpins = 0;      // 無線獎且未觸發 FG 的轉數
+
+    // 依最初觸發倍率分類
+    long long trigX10 = 0, trigX50 = 0, trigX100 = 0;
+
+    // 大獎分層（以單把贏分/押注倍率）
+    long long bigWins = 0, megaWins = 0, superWins = 0, holyWins = 0, jumboWins = 0, jojoWins = 0;
+    long long hiWinBins[NUM_HIGH_BINS] = {};
+    // FG 5 轉批次全空統計
+    long long fgZeroBatches = 0, fgTotalBatches = 0;
+
+    // per-spin 贏分平方和（用於變異/信賴區間；一次方和即 mainLineWinSum + freeGameWinSum）
+    U128 spinWinSumSq;
+    long long nSpins = 0;
+};
+
+/**************
+ * 分佈直方圖：單把總贏分、MG 線獎、每串 FG base（未乘倍率），皆 ×bet
+ * 不放在 Stats 內（約 20 KB）：各 worker 只持有本塊一份，塊完成時交給 ChunkLedger 併入前綴，
+ * 每塊 Stats、遙測快照與亂序暫存因此只有純量
+ **************/
+struct WinDist
+{
+    WinHist spin, mg, fg;
+
+    void merge(const WinDist &o)
+    {
+        spin.merge(o.spin);
+        mg.merge(o.mg);
+        fg.merge(o.fg);
+    }
+};
+
+// 一段塊的完整結果（報表、檢查點與分片的單位）
+struct Tally
+{
+    Stats st;
+    WinDist dist;
+    unique_ptr<LineBreakdown> br; // 僅 LineProbe 實例（--breakdown）配置
+
+    Tally() = default;
+    Tally(const Tally &o) : st(o.st), dist(o.dist), br(o.br ? new LineBreakdown(*o.br) : nullptr) {}
+    Tally(Tally &&) = default;
+    Tally &operator=(const Tally &o)
+    {
+        st = o.st;
+        dist = o.dist;
+        br.reset(o.br ? new LineBreakdown(*o.br) : nullptr);
+        return *this;
+    }
+    Tally &operator=(Tally &&) = default;
+
+    void merge(const Tally &o);
+};
+
+// 併入另一份統計（worker/管線各段/分片皆用此匯總）
+static void mergeStats(Stats &total, const Stats &s)
+{
+    total.mainLineWinSum += s.mainLineWinSum;
+    total.freeGameWinSum += s.freeGameWinSum;
+    total.triggerCount += s.triggerCount;
+    total.retriggerCount += s.retriggerCount;
+    total.totalFGSpins += s.totalFGSpins;
+    total.maxSingleSpin = max(total.maxSingleSpin, s.maxSingleSpin);
+    total.deadSpins += s.deadSpins;
+
+    total.trigX10 += s.trigX10;
+    total.trigX50 += s.trigX50;
+    total.trigX100 += s.trigX100;
+
+    total.bigWins += s.bigWins;
+    total.megaWins += s.megaWins;
+    total.superWins += s.superWins;
+    total.holyWins += s.holyWins;
+    total.jumboWins += s.jumboWins;
+    total.jojoWins += s.jojoWins;
+    for (int bi = 0; bi < NUM_HIGH_BINS; ++bi)
+    {
+        total.hiWinBins[bi] += s.hiWinBins[bi];
+    }
+
+    total.fgZeroBatches += s.fgZeroBatches;
+    total.fgTotalBatches += s.fgTotalBatches;
+
+    total.spinWinSumSq.add(s.spinWinSumSq);
+    total.nSpins += s.nSpins;
+}
+
+void Tally::merge(const Tally &o)
+{
+    mergeStats(st, o.st);
+    dist.merge(o.dist);
+    if (!o.br)
+        return;
+    if (!br)
+        br.reset(new LineBreakdown());
+    br->merge(*o.br);
+}
+
+// 單把 RTP（單把贏分 ÷ 單把押注 numLines 單位）的樣本平均與變異；和為精確整數，只在這裡轉成浮點
+static inline double spinRtpMean(const Stats &s)
+{
+    return s.nSpins ? (double)(s.mainLineWinSum + s.freeGameWinSum) / ((double)s.nSpins * numLines) : 0.0;
+}
+static inline double spinRtpVar(const Stats &s)
+{
+    if (s.nSpins == 0)
+        return 0.0;
+    const double m = spinRtpMean(s);
+    return max(0.0, s.spinWinSumSq.toDouble() / ((double)s.nSpins * numLines * numLines) - m * m);
+}
+
+/**************
+ * 即時統計（每秒；取代只讀 spinsDone 的心跳）
+ * 每個 worker 一個 seqlock 槽位：主迴圈每 4096 轉把「已完成塊累計 + 本塊部分」寫入（序號奇數 = 寫入中），
+ * 遙測執行緒讀到序號一致的快照才採用，主迴圈從不等待讀者
+ * 快照以 atomic<uint64_t> 逐字存放、兩端皆用 relaxed 讀寫，序號前後的 fence 保證一致性（標準 C++ seqlock，無資料競爭）
+ * 輸出：stderr 進度/速度/ETA + 累計 RTP、95% CI、觸發率與大獎次數；
+ * --telemetry FILE 另寫機器可讀格式（jsonl：每秒附加一行；prom：Prometheus 文字格式，每秒整檔取代）
+ **************/
+static atomic<long long> spinsDone{0};
+static string telemetryPath;              // 空 = 只輸出 stderr
+static string telemetryFormat = "jsonl"; // jsonl | prom
+
+static string everyStr(long long totalSpins, long long count)
+{
+    if (count <= 0)
+        return "（—）";
+    ostringstream oss;
+    oss << "（約每 " << llround((double)totalSpins / (double)count) << " 轉一次）";
+    return oss.str();
+}
+
+struct alignas(64) LiveSlot
+{
+    static_assert(is_trivially_copyable<Stats>::value, "LiveSlot 以位元組複製 Stats");
+    static const size_t WORDS = (sizeof(Stats) + 7) / 8;
+    atomic<uint32_t> seq{0};
+    atomic<uint64_t> snap[WORDS];
+
+    LiveSlot()
+    {
+        for (auto &v : snap)
+            v.store(0, memory_order_relaxed);
+    }
+
+    // 單一寫者（該 worker）：先在本地組好快照，臨界區只做逐字 store
+    void publish(const Stats &acc, const Stats &partial)
+    {
+        Stats cur = acc;
+        mergeStats(cur, partial);
+        uint64_t buf[WORDS] = {};
+        memcpy(buf, &cur, sizeof(Stats));
+        uint32_t s = seq.load(memory_order_relaxed);
+        seq.store(s + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        for (size_t i = 0; i < WORDS; i++)
+            snap[i].store(buf[i], memory_order_relaxed);
+        seq.store(s + 2, memory_order_release);
+    }
+    // 讀者：序號為偶數且前後一致才算有效快照
+    Stats read() const
+    {
+        uint64_t buf[WORDS];
+        for (;;)
+        {
+            uint32_t s1 = seq.load(memory_order_acquire);
+            if (s1 & 1)
+            {
+                this_thread::yield();
+                continue;
+            }
+            for (size_t i = 0; i < WORDS; i++)
+                buf[i] = snap[i].load(memory_order_relaxed);
+            atomic_thread_fence(memory_order_acquire);
+            if (seq.load(memory_order_relaxed) == s1)
+            {
+                Stats out;
+                memcpy(&out, buf, sizeof(Stats));
+                return out;
+            }
+        }
+    }
+};
+static unique_ptr<LiveSlot[]> liveSlots; // 排程模式每 worker 一個（管線模式不設，僅輸出進度）
+static int liveSlotCount = 0;
+
+// 寫暫存檔後原子性取代
+static bool writeFileAtomic(const string &path, const vector<char> &buf)
+{
+    string tmp = path + ".tmp";
+    FILE *f = fopen(tmp.c_str(), "wb");
+    if (!f)
+        return false;
+    bool ok = fwrite(buf.data(), 1, buf.size(), f) == buf.size();
+    ok = (fflush(f) == 0) && ok;
+    ok = (fclose(f) == 0) && ok;
+    if (!ok)
+        return false;
+#ifdef _WIN32
+    return MoveFileExA(tmp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return rename(tmp.c_str(), path.c_str()) == 0;
+#endif
+}
+
+class Telemetry
+{
+    thread th;
+    mutex m;
+    condition_variable cv;
+    bool stopping = false;
+
+    // 一次取樣：stderr 兩行 + 可選檔案輸出
+    static void report(double elapsed, long long done, long long total, const Stats &s, FILE *jsonl)
+    {
+        double speed = done / max(1e-9, elapsed);
+        double eta = (total - done) / max(1e-9, speed);
+        std::fprintf(stderr, "[PROGRESS] %lld/%lld (%.2f%%) | %.0f spins/s | ETA %.0fs\n",
+                     done, total, 100.0 * double(done) / double(max(1LL, total)), speed, eta);
+        if (s.nSpins == 0)
+            return;
+
+        double n = (double)s.nSpins;
+        double mean = spinRtpMean(s);
+        double se = sqrt(spinRtpVar(s) / n);
+        double trigRate = (double)s.triggerCount / n;
+        std::fprintf(stderr, "[LIVE] RTP %.6f | 95%% CI [%.6f, %.6f] | 觸發率 %.6f | Big %lld Mega %lld Super %lld Holy %lld Jumbo %lld Jojo %lld\n",
+                     mean, mean - 1.96 * se, mean + 1.96 * se, trigRate,
+                     s.bigWins, s.megaWins, s.superWins, s.holyWins, s.jumboWins, s.jojoWins);
+
+        if (telemetryPath.empty())
+            return;
+        char line[1024];
+        if (telemetryFormat == "prom")
+        {
+            int len = snprintf(line, sizeof(line),
+                               "# TYPE slot_spins_total counter\nslot_spins_total %lld\n"
+                               "# TYPE slot_spins_per_second gauge\nslot_spins_per_second %.0f\n"
+                               "# TYPE slot_rtp gauge\nslot_rtp %.9f\n"
+                               "# TYPE slot_rtp_se gauge\nslot_rtp_se %.9f\n"
+                               "# TYPE slot_trigger_rate gauge\nslot_trigger_rate %.9f\n"
+                               "# TYPE slot_wins_total counter\n"
+                               "slot_wins_total{tier=\"big\"} %lld\nslot_wins_total{tier=\"mega\"} %lld\n"
+                               "slot_wins_total{tier=\"super\"} %lld\nslot_wins_total{tier=\"holy\"} %lld\n"
+                               "slot_wins_total{tier=\"jumbo\"} %lld\nslot_wins_total{tier=\"jojo\"} %lld\n",
+                               s.nSpins, speed, mean, se, trigRate,
+                               s.bigWins, s.megaWins, s.superWins, s.holyWins, s.jumboWins, s.jojoWins);
+            vector<char> buf(line, line + max(0, min(len, (int)sizeof(line) - 1)));
+            if (!writeFileAtomic(telemetryPath, buf))
+                std::fprintf(stderr, "[TELEMETRY] 寫入失敗：%s\n", telemetryPath.c_str());
+        }
+        else if (jsonl)
+        {
+            fprintf(jsonl,
+                    "{\"t\":%.3f,\"spins\":%lld,\"target\":%lld,\"spins_per_s\":%.0f,\"rtp\":%.9f,\"se\":%.9f,"
+                    "\"ci_lo\":%.9f,\"ci_hi\":%.9f,\"trigger_rate\":%.9f,\"big\":%lld,\"mega\":%lld,"
+                    "\"super\":%lld,\"holy\":%lld,\"jumbo\":%lld,\"jojo\":%lld}\n",
+                    elapsed, s.nSpins, total, speed, mean, se, mean - 1.96 * se, mean + 1.96 * se, trigRate,
+                    s.bigWins, s.megaWins, s.superWins, s.holyWins, s.jumboWins, s.jojoWins);
+            fflush(jsonl);
+        }
+    }
+
+public:
+    // total：本次要跑的轉數；base：已併入的統計（續跑載入的塊）
+    Telemetry(long long total, const Stats &base)
+    {
+        th = thread([this, total, base]()
+                    {
+            auto start = chrono::steady_clock::now();
+            FILE *jsonl = nullptr;
+            if (!telemetryPath.empty() && telemetryFormat != "prom")
+            {
+                jsonl = fopen(telemetryPath.c_str(), "a");
+                if (!jsonl)
+                    std::fprintf(stderr, "[TELEMETRY] 無法開啟 %s\n", telemetryPath.c_str());
+            }
+            for (;;)
+            {
+                {
+                    unique_lock<mutex> lk(m);
+                    if (cv.wait_for(lk, chrono::seconds(1), [&]
+                                    { return stopping; }))
+                        break;
+                }
+                Stats s = base;
+                for (int i = 0; i < liveSlotCount; i++)
+                    mergeStats(s, liveSlots[i].read());
+                double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+                report(elapsed, spinsDone.load(memory_order_relaxed), total, s, jsonl);
+            }
+            if (jsonl)
+                fclose(jsonl); });
+    }
+    // 通知並 join（可重複呼叫）
+    void stop()
+    {
+        if (!th.joinable())
+            return;
+        {
+            lock_guard<mutex> lk(m);
+            stopping = true;
+        }
+        cv.notify_one();
+        th.join();
+    }
+    ~Telemetry() { stop(); }
+};
+
+/**************
+ * 單把收尾：觸發 FG → 加總 → 峰值/分層/RTP 統計
+ * 逐把、批次與管線路徑共用，確保 FG 亂數消耗與 Stats 累加順序一致
+ **************/
+// 觸發計數，回傳 FG 倍率
+static inline int recordTrigger(const GameDef &d, Stats &local, int s)
+{
+    local.triggerCount++;
+    if (s >= 5)
+        local.trigX100++;
+    else if (s == 4)
+        local.trigX50++;
+    else
+        local.trigX10++;
+    return fgMulByScatter(d, s);
+}
+
+// 一整串 FG 併入統計，回傳乘上倍率後的 FG 贏分（線注單位）
+static inline long long recordFG(Stats &local, WinDist &dist, const tuple<int, long long, int, int, int> &fg, int mul)
+{
+    auto [fgSp, fgBase, retri, zeroB, totalB] = fg;
+    local.totalFGSpins += fgSp;
+    local.retriggerCount += retri;
+    local.fgZeroBatches += zeroB;
+    local.fgTotalBatches += totalB;
+
+    dist.fg.add((double)fgBase / numLines);
+
+    const long long fgWin = fgBase * mul;
+    local.freeGameWinSum += fgWin;
+    return fgWin;
+}
+
+// 單把總贏分（MG+FG）→ 峰值 / 分層 / per-spin RTP / 分佈直方圖
+static inline void recordSpinTotal(const GameDef &d, Stats &local, WinDist &dist, long long mgLine, long long spinTotal)
+{
+    dist.mg.add((double)mgLine / numLines);
+    if (spinTotal > local.maxSingleSpin)
+        local.maxSingleSpin = spinTotal;
+
+    const double ratio = (double)spinTotal / numLines; // 單把贏分/押注 倍率
+    const double *e = d.tierEdge;
+    if (ratio >= e[5])
+        local.jojoWins++;
+    else if (ratio >= e[4])
+        local.jumboWins++;
+    else if (ratio >= e[3])
+        local.holyWins++;
+    else if (ratio >= e[2])
+        local.superWins++;
+    else if (ratio >= e[1])
+        local.megaWins++;
+    else if (ratio >= e[0])
+        local.bigWins++;
+
+    // x1000 以上再分層
+    if (ratio >= HIGH_BIN_EDGES[0])
+    {
+        // 從最大門檻往回找，找到第一個符合 ratio >= edge 的 bin
+        for (int bi = NUM_HIGH_BINS - 1; bi >= 0; --bi)
+        {
+            if (ratio >= HIGH_BIN_EDGES[bi])
+            {
+                local.hiWinBins[bi]++;
+                break;
+            }
+        }
+    }
+
+    //  per-spin RTP 統計
+    local.spinWinSumSq.addSquare((uint64_t)spinTotal);
+    local.nSpins++;
+    dist.spin.add(ratio);
+}
+
+// 回傳單把總贏分（線注單位；--sweep 以此算配對差）
+template <class Probe = NoProbe, class Rng>
+static inline long long finishSpin(const Game &g, Rng &rngFG, Window5x3 *w, long long mgLine, int s, Stats &local,
+                                   WinDist &dist, Probe probe = Probe())
+{
+    long long spinTotal = mgLine;
+
+    //  觸發 FG？（3+S）：跑完整串 FG（換 FG 輪帶/賠率），回來加總
+    if (s >= 3)
+    {
+        const int mul = recordTrigger(g.def, local, s);
+#ifdef SLOT_PROFILE
+        profDepth = -1;
+        const uint64_t t0 = profTicks();
+        auto fg = drawFG(g, rngFG, w, probe.at(mul));
+        profRecordFG(get<0>(fg), get<2>(fg), profTicks() - t0);
+        spinTotal += recordFG(local, dist, fg, mul);
+#else
+        spinTotal += recordFG(local, dist, drawFG(g, rngFG, w, probe.at(mul)), mul);
+#endif
+    }
+    else if (mgLine == 0)
+    {
+        local.deadSpins++; // MG 無線獎且沒進 FG
+    }
+
+    local.mainLineWinSum += mgLine;
+    recordSpinTotal(g.def, local, dist, mgLine, spinTotal);
+    return spinTotal;
+}
+
+/**************
+ * 批次（SoA）模式：一個區塊 N 把分階段處理（--batch N）
+ *   (1) 依把、依軸順序抽停點（與逐把路徑消耗相同的 MG 亂數序列）
+ *   (2) 填視窗 → (3) 線獎 → (4) 數 S，各為一個緊密迴圈
+ *   (5) 依把序對觸發者跑 playFG 並併入 Stats（FG 用獨立亂數流，順序與逐把相同）
+ **************/
+static int batchSize = 0; // 0 = 逐把
+
+struct SpinBlock
+{
+    vector<uint32_t> stop[5]; // 各軸停點
+    vector<Window5x3> win;    // 視窗
+    vector<int32_t> line;     // 線獎總倍率（線注單位）
+    vector<uint8_t> scatter;  // S 數
+
+    explicit SpinBlock(size_t n) : win(n), line(n), scatter(n)
+    {
+        for (auto &v : stop)
+            v.resize(n);
+    }
+};
+
+template <class Probe = NoProbe, class Rng>
+static void runBlock(const Game &g, Rng &rngMG, Rng &rngFG, SpinBlock &B, size_t n, Window5x3 *fgWin, Stats &local,
+                     WinDist &dist, Probe probe)
+{
+    const ReelSet &R = g.def.reels[MG];
+    for (size_t i = 0; i < n; i++)
+        for (int r = 0; r < 5; r++)
+            B.stop[r][i] = boundedRand(rngMG, (uint32_t)R.len[r]);
+
+    if (evalEngine == EvalEngine::Column)
+    {
+        const ColumnTables &T = g.col[MG];
+        for (size_t i = 0; i < n; i++)
+        {
+            uint8_t c[5];
+            int sc = 0;
+            for (int r = 0; r < 5; r++)
+            {
+                c[r] = T.colOfStop[r][B.stop[r][i]];
+                sc += T.colScatter[r][c[r]];
+            }
+            B.line[i] = T.lineWin(c);
+            B.scatter[i] = (uint8_t)sc;
+        }
+    }
+    else
+    {
+        for (int r = 0; r < 5; r++)
+            for (size_t i = 0; i < n; i++)
+                memcpy(B.win[i].c[r], &R.sym[r][B.stop[r][i]], 3);
+        for (size_t i = 0; i < n; i++)
+            B.line[i] = evalLines<MG>(g.def, g.bb[MG], &B.win[i]);
+        for (size_t i = 0; i < n; i++)
+            B.scatter[i] = (uint8_t)countScatter(&B.win[i]);
+        if constexpr (Probe::on)
+            for (size_t i = 0; i < n; i++)
+                probe.template spin<MG>(g.def.pay[MG], g.def.lines, &B.win[i]);
+    }
+
+    for (size_t i = 0; i < n; i++)
+        finishSpin<Probe>(g, rngFG, fgWin, B.line[i], B.scatter[i], local, dist, probe);
+}
+
+// FG 亂數流種子：與 MG 流錯開（SplitMix64 一步）
+static inline uint64_t fgStreamSeed(uint64_t seed)
+{
+    return splitmix64(seed);
+}
+
+/**************
+ * 跑一段轉數（沿用呼叫端的亂數流與本地統計；worker 與排程器每塊共用）
+ * MG 與 FG 各用一條亂數流；B 非空時走批次路徑，統計與逐把路徑逐位元相同
+ * live 非空時每 4096 轉（批次：每區塊）發布 acc + local 快照給遙測執行緒
+ **************/
+template <class Probe = NoProbe, class Rng>
+static void runSpins(const Game &g, Rng &rngMG, Rng &rngFG, Window5x3 *w, SpinBlock *B, long long spins, Stats &local,
+                     WinDist &dist, Probe probe = Probe(), LiveSlot *live = nullptr, const Stats *acc = nullptr)
+{
+    if (B)
+    {
+        for (long long done = 0; done < spins;)
+        {
+            size_t n = (size_t)min<long long>(batchSize, spins - done);
+            runBlock<Probe>(g, rngMG, rngFG, *B, n, w, local, dist, probe);
+            done += (long long)n;
+            spinsDone.fetch_add((long long)n, memory_order_relaxed);
+            if (live)
+                live->publish(*acc, local);
+        }
+        return;
+    }
+
+    const long long bump = 4096; // 降低 atomic 次數
+    long long bumpCnt = 0;
+    for (long long i = 0; i < spins; i++)
+    {
+        //  主遊戲轉窗 + 線獎（未觸發 FG 時也可能有線獎）
+        SpinOutcome o = spinEval<MG>(g, rngMG, w);
+        if constexpr (Probe::on)
+            probe.template spin<MG>(g.def.pay[MG], g.def.lines, w);
+        finishSpin<Probe>(g, rngFG, w, o.line, o.scatter, local, dist, probe);
+
+        //  進度累加 + 即時快照（每 4096 轉一次）
+        if (++bumpCnt == bump)
+        {
+            spinsDone.fetch_add(bump, memory_order_relaxed);
+            if (live)
+                live->publish(*acc, local);
+            bumpCnt = 0;
+        }
+    }
+    if (bumpCnt > 0)
+        spinsDone.fetch_add(bumpCnt, memory_order_relaxed);
+}
+
+/**************
+ * Worker：負責跑自己份內的轉數（本地統計 → 結束時寫回）
+ **************/
+template <class Rng>
+static void worker(const Game &g, long long spins, Tally *out, uint64_t seed)
+{
+    Rng rngMG(seed), rngFG(fgStreamSeed(seed));
+    Window5x3 w{};
+    Tally local{};
+    unique_ptr<SpinBlock> B;
+    if (batchSize > 0)
+        B.reset(new SpinBlock((size_t)batchSize));
+
+    runSpins(g, rngMG, rngFG, &w, B.get(), spins, local.st, local.dist);
+
+    *out = local; // 將本地統計回寫
+}
+
+// 批次自檢（--batch-check N）：同一種子下逐把與批次路徑各跑 N 把，比對整份 Stats 與直方圖
+static bool batchSelfCheck(long long n)
+{
+    bool ok = true;
+    const int savedBatch = batchSize;
+    withRng(rngKind, [&](auto tag)
+            {
+        using R = typename decltype(tag)::type;
+        unique_ptr<Tally> ref(new Tally()), got(new Tally());
+        batchSize = 0;
+        worker<R>(*games[0], n, ref.get(), 0x9E3779B97F4A7C15ULL);
+        for (int bs : {1, 7, 256, max(1, savedBatch)})
+        {
+            batchSize = bs;
+            worker<R>(*games[0], n, got.get(), 0x9E3779B97F4A7C15ULL);
+            bool same = memcmp(&ref->st, &got->st, sizeof(Stats)) == 0 && // 全為 8-byte 欄位，無 padding
+                        memcmp(&ref->dist, &got->dist, sizeof(WinDist)) == 0;
+            std::fprintf(stderr, "[BATCH] block=%-6d : %s\n", bs, same ? "與逐把路徑一致" : "不一致");
+            ok = ok && same;
+        } });
+    batchSize = savedBatch;
+    spinsDone.store(0);
+    return ok;
+}
+
+/**************
+ * 工作竊取排程（預設；--sched static 則各 worker 只跑自己分到的塊）
+ * 總轉數切成 --chunk 大小的固定塊，依序輪流發到各 worker 的雙端佇列；
+ * 自己從前端取（塊號小者先跑），佇列空時輪詢其他 worker 從尾端偷
+ * 每塊有自己的 MG/FG 亂數子流（由 --seed 與塊號導出）與自己的 Stats，最後依塊號順序合併，
+ * 故同一 (seed, spins, chunk, rng) 不論幾條 thread、誰偷了哪塊，結果逐位元相同
+ **************/
+enum class Sched
+{
+    Static,
+    Steal
+};
+static Sched schedMode = Sched::Steal;
+static long long chunkSpins = 1LL << 20; // 每塊轉數（與 --seed 一同決定結果；改變即不同實驗）
+static uint64_t runSeed = 0;             // --seed；未指定時取時鐘
+static bool seedGiven = false;
+static long long chunkFirst = 0, chunkLast = -1; // --chunk-range A:B 只跑 [A, B) 塊（-1 = 到最後）
+
+// 塊 c 的 MG / FG 子流編號
+static inline uint64_t chunkStreamMG(long long c) { return (uint64_t)c * 2; }
+static inline uint64_t chunkStreamFG(long long c) { return (uint64_t)c * 2 + 1; }
+
+// 綁核：none 不綁；all 綁到所有邏輯核心（先各實體核第一條，再 SMT 兄弟）；physical 每實體核只用一條
+enum class Affinity
+{
+    None,
+    All,
+    Physical
+};
+static Affinity affinityMode = Affinity::None;
+static bool threadsGiven = false; // --threads 有指定時不以綁核清單覆寫 worker 數
+
+// 邏輯 CPU 清單（first：每實體核一條；second：其餘 SMT 兄弟）
+static pair<vector<int>, vector<int>> cpuTopology()
+{
+    vector<int> primary, sibling;
+#if defined(__linux__)
+    map<pair<int, int>, int> seen; // (package, core) → 第一條邏輯 CPU
+    for (int cpu = 0;; cpu++)
+    {
+        string base = "/sys/devices/system/cpu/cpu" + to_string(cpu) + "/topology/";
+        ifstream pkg(base + "physical_package_id"), core(base + "core_id");
+        if (!pkg || !core)
+            break;
+        int p = 0, c = 0;
+        pkg >> p;
+        core >> c;
+        if (seen.emplace(make_pair(p, c), cpu).second)
+            primary.push_back(cpu);
+        else
+            sibling.push_back(cpu);
+    }
+#elif defined(_WIN32)
+    DWORD len = 0;
+    GetLogicalProcessorInformation(nullptr, &len);
+    vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(len / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+    if (!info.empty() && GetLogicalProcessorInformation(info.data(), &len))
+    {
+        for (const auto &e : info)
+        {
+            if (e.Relationship != RelationProcessorCore)
+                continue;
+            bool first = true;
+            for (int b = 0; b < (int)(sizeof(ULONG_PTR) * 8); b++)
+            {
+                if (!((e.ProcessorMask >> b) & 1))
+                    continue;
+                (first ? primary : sibling).push_back(b);
+                first = false;
+            }
+        }
+    }
+#endif
+    if (primary.empty()) // 偵測不到拓撲：視每條硬體執行緒為一核
+    {
+        for (int i = 0; i < (int)max(1u, thread::hardware_concurrency()); i++)
+            primary.push_back(i);
+        sibling.clear();
+    }
+    return {primary, sibling};
+}
+
+// 依 affinityMode 取得綁核順序（空 = 不綁）
+static vector<int> affinityCpus()
+{
+    if (affinityMode == Affinity::None)
+        return {};
+    auto topo = cpuTopology();
+    vector<int> cpus = topo.first;
+    if (affinityMode == Affinity::All)
+        cpus.insert(cpus.end(), topo.second.begin(), topo.second.end());
+    return cpus;
+}
+
+static bool pinCurrentThread(int cpu)
+{
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+    return cpu < 64 && SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+struct alignas(64) WorkDeque
+{
+    mutex m;
+    deque<long long> q; // 工作號（見 ChunkScheduler）
+};
+
+struct WorkerReport
+{
+    long long spins = 0;
+    long long chunks = 0;
+    long long stolen = 0;
+    double busySec = 0;
+    double idleSec = 0; // 牆鐘 - 忙碌（含找工作與提早收工等其他人）
+    int cpu = -1;       // 綁定的邏輯 CPU（-1 = 未綁）
+#ifdef SLOT_PROFILE
+    PhaseProfile prof;
+#endif
+};
+
+// 工作號 j ∈ [0, jobs)：單一遊戲時即 --chunk-range 內第 j 塊；多遊戲時由 jobOf() 拆成（遊戲, 塊）
+class ChunkScheduler
+{
+    vector<WorkDeque> dq;
+    bool steal;
+
+public:
+    // skip[j] 非零的工作（續跑時已完成）不發
+    ChunkScheduler(int workers, long long jobs, bool allowSteal, const vector<uint8_t> &skip)
+        : dq((size_t)workers), steal(allowSteal)
+    {
+        long long k = 0;
+        for (long long j = 0; j < jobs; j++)
+            if ((size_t)j >= skip.size() || !skip[(size_t)j])
+                dq[(size_t)(k++ % workers)].q.push_back(j);
+    }
+
+    // 取下一份工作：先自己前端，再依序向其他 worker 尾端偷；全空回 -1
+    // drop(j) 為真者（該遊戲精度目標已達成）直接丟棄
+    template <class Drop>
+    long long next(int id, bool &stolen, Drop drop)
+    {
+        {
+            lock_guard<mutex> lk(dq[id].m);
+            while (!dq[id].q.empty())
+            {
+                long long c = dq[id].q.front();
+                dq[id].q.pop_front();
+                if (drop(c))
+                    continue;
+                stolen = false;
+                return c;
+            }
+        }
+        const int W = steal ? (int)dq.size() : 1;
+        for (int k = 1; k < W; k++)
+        {
+            WorkDeque &v = dq[(id + k) % W];
+            lock_guard<mutex> lk(v.m);
+            while (!v.q.empty())
+            {
+                long long c = v.q.back();
+                v.q.pop_back();
+                if (drop(c))
+                    continue;
+                stolen = true;
+                return c;
+            }
+        }
+        return -1;
+    }
+};
+
+// 塊號範圍（--chunk-range 夾到 [0, 總塊數]）
+static pair<long long, long long> chunkRange()
+{
+    long long n = (numSpins + chunkSpins - 1) / chunkSpins;
+    long long a = min(max(0LL, chunkFirst), n);
+    long long b = chunkLast < 0 ? n : min(chunkLast, n);
+    return {a, max(a, b)};
+}
+
+// 範圍內實際要跑的轉數
+static long long rangeSpins()
+{
+    auto [a, b] = chunkRange();
+    if (a >= b)
+        return 0;
+    return min(numSpins, b * chunkSpins) - a * chunkSpins;
+}
+
+static long long chunkLen(long long c) { return min(chunkSpins, numSpins - c * chunkSpins); }
+
+// 工作號 → (遊戲索引, 範圍內塊序)：--interleave 時同一塊的各遊戲相鄰發出，否則逐遊戲依序
+static pair<size_t, size_t> jobOf(long long j, size_t games, size_t chunks)
+{
+    if (interleaveGames)
+        return {(size_t)j % games, (size_t)j / games};
+    return {(size_t)j / chunks, (size_t)j % chunks};
+}
+
+/**************
+ * FG 串快取：建表 / 存檔 / 載入 / 與實跑比對（--fg-cache N、--fg-cache-file FILE、--fg-cache-check M）
+ * 建表以塊切分平行跑（子流編號與主模擬錯開），各塊排序合併後整體再排序合併 → 與 thread 數無關
+ * 檔頭記錄 FG 輪帶/賠率/線圖/轉數的雜湊，不符即重建並覆寫
+ **************/
+static long long fgCacheSessions = 0; // 0 = 不用快取（僅給 --fg-cache-file 時預設 1<<24）
+static string fgCachePath;
+static long long fgCacheCheck = 0; // 比對用的實跑串數
+static const uint64_t FG_CACHE_STREAM = 1ULL << 62;       // 建表子流起點
+static const uint64_t FG_CHECK_STREAM = 3ULL << 61;       // 比對子流起點
+
+struct FgCacheHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t key;      // 定義雜湊
+    uint64_t sessions; // 建表串數
+    uint64_t n;        // 相異結果數
+    uint64_t seed;
+    uint64_t pad[2]; // 補到 64 bytes，後接 FgOutcome[n]、uint64 門檻[n]、uint32 alias[n]
+};
+static const char FG_CACHE_MAGIC[8] = {'S', 'L', 'O', 'T', 'F', 'G', 'C', '1'};
+
+static uint64_t fnv1a(uint64_t h, const void *p, size_t n)
+{
+    const unsigned char *c = (const unsigned char *)p;
+    for (size_t i = 0; i < n; i++)
+        h = (h ^ c[i]) * 1099511628211ULL;
+    return h;
+}
+
+// FG 結果只取決於 FG 輪帶、FG 賠率、線圖與每次轉數（base 為線注單位，與 betPerLine 無關）
+static uint64_t fgCacheKey(const GameDef &d)
+{
+    uint64_t h = 14695981039346656037ULL;
+    h = fnv1a(h, d.reels[FG].sym, sizeof(d.reels[FG].sym));
+    h = fnv1a(h, d.reels[FG].len, sizeof(d.reels[FG].len));
+    h = fnv1a(h, d.pay[FG].data(), sizeof(d.pay[FG]));
+    h = fnv1a(h, d.lines.data(), sizeof(d.lines));
+    h = fnv1a(h, &d.fgSpins, sizeof(d.fgSpins));
+    return h;
+}
+
+static bool fgLess(const FgOutcome &a, const FgOutcome &b)
+{
+    return tie(a.base, a.spins, a.retri, a.zeroBatches, a.totalBatches) <
+           tie(b.base, b.spins, b.retri, b.zeroBatches, b.totalBatches);
+}
+static bool fgSame(const FgOutcome &a, const FgOutcome &b)
+{
+    return !fgLess(a, b) && !fgLess(b, a);
+}
+
+// 已排序的 (結果, 次數) 串接後重排並合併相同結果
+static vector<pair<FgOutcome, uint64_t>> collapseOutcomes(vector<pair<FgOutcome, uint64_t>> v)
+{
+    sort(v.begin(), v.end(), [](const auto &x, const auto &y)
+         { return fgLess(x.first, y.first); });
+    vector<pair<FgOutcome, uint64_t>> out;
+    for (const auto &e : v)
+        if (!out.empty() && fgSame(out.back().first, e.first))
+            out.back().second += e.second;
+        else
+            out.push_back(e);
+    return out;
+}
+
+// 指標指向 buf 內各段（建表、讀檔、mmap 共用）
+static void bindFgCache(FgCache &c, const char *buf)
+{
+    const FgCacheHeader *h = (const FgCacheHeader *)buf;
+    c.n = h->n;
+    c.sessions = h->sessions;
+    c.out = (const FgOutcome *)(buf + sizeof(FgCacheHeader));
+    c.thresh = (const uint64_t *)(c.out + c.n);
+    c.alias = (const uint32_t *)(c.thresh + c.n);
+}
+
+static size_t fgCacheBytes(uint64_t n)
+{
+    return sizeof(FgCacheHeader) + n * (sizeof(FgOutcome) + sizeof(uint64_t) + sizeof(uint32_t));
+}
+
+// Vose 建 alias 表：q_i = n·p_i，小於 1 者與大於 1 者配對
+static unique_ptr<FgCache> makeFgCache(const vector<pair<FgOutcome, uint64_t>> &hist, uint64_t sessions, uint64_t key)
+{
+    const uint64_t n = hist.size();
+    unique_ptr<FgCache> c(new FgCache);
+    c->own.assign(fgCacheBytes(n), 0);
+    FgCacheHeader *h = (FgCacheHeader *)c->own.data();
+    memcpy(h->magic, FG_CACHE_MAGIC, 8);
+    h->version = 1;
+    h->key = key;
+    h->sessions = sessions;
+    h->n = n;
+    h->seed = runSeed;
+    bindFgCache(*c, c->own.data());
+    FgOutcome *out = (FgOutcome *)c->out;
+    uint64_t *thresh = (uint64_t *)c->thresh;
+    uint32_t *alias = (uint32_t *)c->alias;
+
+    vector<double> q(n);
+    vector<uint32_t> small, large;
+    for (uint64_t i = 0; i < n; i++)
+    {
+        out[i] = hist[i].first;
+        q[i] = (double)hist[i].second * (double)n / (double)sessions;
+        (q[i] < 1.0 ? small : large).push_back((uint32_t)i);
+    }
+    const double one = 4294967296.0; // 2^32
+    while (!small.empty() && !large.empty())
+    {
+        uint32_t s = small.back(), l = large.back();
+        small.pop_back();
+        thresh[s] = (uint64_t)(q[s] * one);
+        alias[s] = l;
+        q[l] -= 1.0 - q[s];
+        if (q[l] < 1.0)
+        {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    for (uint32_t i : large) // 捨入殘差：視為整格
+    {
+        thresh[i] = (uint64_t)one;
+        alias[i] = i;
+    }
+    for (uint32_t i : small)
+    {
+        thresh[i] = (uint64_t)one;
+        alias[i] = i;
+    }
+    return c;
+}
+
+template <class Rng>
+static unique_ptr<FgCache> buildFgCache(const Game &g, long long sessions)
+{
+    const long long chunks = (sessions + chunkSpins - 1) / chunkSpins;
+    vector<vector<pair<FgOutcome, uint64_t>>> part((size_t)chunks);
+    ChunkScheduler S(numWorkers, chunks, schedMode == Sched::Steal, {});
+    vector<thread> threads;
+    for (int i = 0; i < numWorkers; i++)
+        threads.emplace_back([&, i]()
+                             {
+            Window5x3 w{};
+            bool stolen = false;
+            for (long long c; (c = S.next(i, stolen, [](long long) { return false; })) >= 0;)
+            {
+                Rng rng = makeStream<Rng>(runSeed, FG_CACHE_STREAM + (uint64_t)c);
+                long long n = min(chunkSpins, sessions - c * chunkSpins);
+                vector<pair<FgOutcome, uint64_t>> v((size_t)n);
+                for (auto &e : v)
+                {
+                    auto [sp, base, retri, zb, tb] = playFG(g, rng, &w);
+                    e = {FgOutcome{base, sp, retri, zb, tb}, 1};
+                }
+                part[(size_t)c] = collapseOutcomes(move(v));
+            } });
+    for (auto &th : threads)
+        th.join();
+
+    vector<pair<FgOutcome, uint64_t>> all;
+    for (auto &p : part)
+    {
+        all.insert(all.end(), p.begin(), p.end());
+        vector<pair<FgOutcome, uint64_t>>().swap(p);
+    }
+    return makeFgCache(collapseOutcomes(move(all)), (uint64_t)sessions, fgCacheKey(g.def));
+}
+
+// 讀檔（POSIX 以 mmap 唯讀映射，其餘整檔讀入）；不存在或雜湊不符回傳空
+static unique_ptr<FgCache> loadFgCache(const string &path, uint64_t key)
+{
+    unique_ptr<FgCache> c(new FgCache);
+    const char *buf = nullptr;
+    size_t len = 0;
+#if !defined(_WIN32)
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(FgCacheHeader))
+    {
+        close(fd);
+        return nullptr;
+    }
+    len = (size_t)st.st_size;
+    void *m = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED)
+        return nullptr;
+    c->map = m;
+    c->mapLen = len;
+    buf = (const char *)m;
+#else
+    ifstream in(path, ios::binary);
+    if (!in)
+        return nullptr;
+    c->own.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    len = c->own.size();
+    if (len < sizeof(FgCacheHeader))
+        return nullptr;
+    buf = c->own.data();
+#endif
+    const FgCacheHeader *h = (const FgCacheHeader *)buf;
+    if (memcmp(h->magic, FG_CACHE_MAGIC, 8) != 0 || h->version != 1 || h->key != key || len != fgCacheBytes(h->n))
+        return nullptr;
+    bindFgCache(*c, buf);
+    return c;
+}
+
+// 由 alias 表還原各結果機率：p_i = (門檻_i + Σ_{alias_j = i} (2^32 − 門檻_j)) / (n·2^32)
+static vector<double> fgCacheProbs(const FgCache &c)
+{
+    const double one = 4294967296.0;
+    vector<double> p(c.n, 0.0);
+    for (uint64_t i = 0; i < c.n; i++)
+    {
+        p[i] += (double)c.thresh[i] / one;
+        p[c.alias[i]] += 1.0 - (double)c.thresh[i] / one;
+    }
+    for (double &v : p)
+        v /= (double)c.n;
+    return p;
+}
+
+// 快取 vs 實跑：base 的均值/標準差、兩樣本 KS、高分位與尾端超出快取最大值的串數
+template <class Rng>
+static void checkFgCache(const Game &g, const FgCache &c, long long m)
+{
+    const string &tag = g.def.name;
+    vector<double> live((size_t)m);
+    Window5x3 w{};
+    Rng rng = makeStream<Rng>(runSeed, FG_CHECK_STREAM);
+    for (double &b : live)
+        b = (double)get<1>(playFG(g, rng, &w)) * betPerLine;
+    sort(live.begin(), live.end());
+
+    vector<double> p = fgCacheProbs(c);
+    auto cb = [&](uint64_t i) { return (double)c.out[i].base * betPerLine; }; // 與實跑同以金額比較
+    double cm = 0, cm2 = 0, lm = 0, lm2 = 0;
+    for (uint64_t i = 0; i < c.n; i++)
+    {
+        cm += p[i] * cb(i);
+        cm2 += p[i] * cb(i) * cb(i);
+    }
+    for (double b : live)
+    {
+        lm += b;
+        lm2 += b * b;
+    }
+    lm /= (double)m;
+    lm2 /= (double)m;
+    const double lsd = sqrt(max(0.0, lm2 - lm * lm)), csd = sqrt(max(0.0, cm2 - cm * cm));
+    const double z = (cm - lm) / max(1e-12, lsd / sqrt((double)m));
+
+    // KS：兩個已排序序列同步走（快取以機率加權）
+    double D = 0, F = 0, Gc = 0;
+    size_t j = 0;
+    for (uint64_t i = 0; i < c.n;)
+    {
+        double x = cb(i);
+        for (; i < c.n && cb(i) == x; i++)
+            F += p[i];
+        for (; j < live.size() && live[j] <= x; j++)
+            ;
+        Gc = (double)j / (double)m;
+        D = max(D, fabs(F - Gc));
+    }
+    const double N = (double)c.sessions, crit = 1.36 * sqrt((N + (double)m) / (N * (double)m));
+
+    auto cacheQuantile = [&](double q)
+    {
+        double acc = 0;
+        for (uint64_t i = 0; i < c.n; i++)
+            if ((acc += p[i]) >= q)
+                return cb(i);
+        return cb(c.n - 1);
+    };
+    const double maxCached = cb(c.n - 1);
+    const long long beyond = (long long)(live.end() - upper_bound(live.begin(), live.end(), maxCached));
+    const double expectBeyond = (double)m / (N + 1.0);
+
+    std::fprintf(stderr, "[FGCACHE] %s 比對 %lld 串實跑 | base 均值 快取 %.6f / 實跑 %.6f（z = %.2f）| 標準差 %.4f / %.4f\n",
+                 tag.c_str(), m, cm, lm, z, csd, lsd);
+    std::fprintf(stderr, "[FGCACHE] %s KS D = %.5f（5%% 臨界 %.5f）%s\n", tag.c_str(), D, crit,
+                 D > crit ? "→ 分佈不符" : "");
+    const double qs[] = {0.99, 0.999, 0.9999};
+    for (double q : qs)
+    {
+        size_t k = min(live.size() - 1, (size_t)(q * (double)m));
+        std::fprintf(stderr, "[FGCACHE] %s 分位 %.4f | 快取 %.2f | 實跑 %.2f\n", tag.c_str(), q, cacheQuantile(q), live[k]);
+    }
+    bool tailShort = (double)beyond > expectBeyond + 3.0 * sqrt(expectBeyond) + 1.0;
+    std::fprintf(stderr, "[FGCACHE] %s 快取最高 base %.2f（最小可表機率 1/%llu）| 實跑超出 %lld 串（預期 %.1f）%s\n",
+                 tag.c_str(), maxCached, (unsigned long long)c.sessions, beyond, expectBeyond,
+                 tailShort || D > crit || fabs(z) > 4 ? "→ 快取太小，尾端不可信，請加大 --fg-cache" : "");
+}
+
+// 各遊戲建立或載入快取（--fg-cache-file 僅單一遊戲）
+template <class Rng>
+static void prepareFgCaches()
+{
+    for (auto &gp : games)
+    {
+        Game &g = *gp;
+        const uint64_t key = fgCacheKey(g.def);
+        auto t0 = chrono::steady_clock::now();
+        if (!fgCachePath.empty() && (g.fgCache = loadFgCache(fgCachePath, key)))
+            std::fprintf(stderr, "[FGCACHE] %s 載入 %s | %llu 串 → %llu 種結果 | %.1f MB | %.2fs\n", g.def.name.c_str(),
+                         fgCachePath.c_str(), (unsigned long long)g.fgCache->sessions, (unsigned long long)g.fgCache->n,
+                         (double)fgCacheBytes(g.fgCache->n) / (1024.0 * 1024.0),
+                         chrono::duration<double>(chrono::steady_clock::now() - t0).count());
+        if (g.fgCache && fgCacheSessions > 0 && (long long)g.fgCache->sessions != fgCacheSessions)
+            g.fgCache.reset(); // 指定的串數與檔案不同：重建
+        if (!g.fgCache)
+        {
+            long long n = fgCacheSessions > 0 ? fgCacheSessions : (1LL << 24);
+            g.fgCache = buildFgCache<Rng>(g, n);
+            std::fprintf(stderr, "[FGCACHE] %s 建表 %lld 串 → %llu 種結果 | %.1f MB | %.2fs\n", g.def.name.c_str(), n,
+                         (unsigned long long)g.fgCache->n, (double)fgCacheBytes(g.fgCache->n) / (1024.0 * 1024.0),
+                         chrono::duration<double>(chrono::steady_clock::now() - t0).count());
+            if (!fgCachePath.empty() && !writeFileAtomic(fgCachePath, g.fgCache->own))
+                std::fprintf(stderr, "[FGCACHE] 寫入失敗：%s\n", fgCachePath.c_str());
+        }
+        if (fgCacheCheck > 0)
+            checkFgCache<Rng>(g, *g.fgCache, fgCacheCheck);
+    }
+}
+
+/**************
+ * 精度目標模式（--target-se X 或 --target-halfwidth H = 1.96·SE；--spins 變為上限）
+ * 停止判定只看「從第一塊起連續完成」的前綴：前綴每延長一塊就以其合併 Stats 重算 per-spin RTP 的 SE，
+ * 須同時滿足 SE ≤ 目標、FG 觸發數 ≥ --min-triggers、轉數 ≥ --min-spins，且此條件自首次成立後
+ * 再延長 max(8 塊, 10% 塊數) 仍持續成立（FG 長尾使 SE 在大獎出現前偏低，確認窗可擋掉過早停止；
+ * 8 塊下限避免前綴很短時 10% 只剩一塊）；達標後不再發更後面的塊，結果只含該前綴，
+ * 故與 thread 數無關、可由 --seed 重現
+ **************/
+static double targetSE = 0;          // 0 = 跑滿 --spins
+static long long minTriggers = 10000; // 停止前至少需要的 FG 觸發數
+static long long minSpins = 0;        // 停止前前綴至少需要的轉數
+static const size_t MIN_CONFIRM_CHUNKS = 8; // 確認窗下限（塊）
+
+/**************
+ * 各塊結果彙整（每個遊戲一份）：完成的塊若接在連續前綴之後即併入前綴的累計 Stats，
+ * 先完成的後段塊（亂序）暫存到前綴延伸過去為止 → 記憶體只與亂序深度有關，不隨 --spins 成長
+ * 併入一律依塊號順序，精度目標於前綴每延長一塊時判定；檢查點只寫前綴累計 + 完成位元圖 + 亂序塊
+ **************/
+class ChunkLedger
+{
+    mutable mutex m;
+    long long first;
+    size_t prefix = 0, candidate = 0;
+    size_t top = 0;     // 前綴中單把最高所在塊（相對 first）
+    size_t dropped = 0; // 達標後才完成的超跑塊
+    Tally acc{};
+    map<size_t, Tally> pending; // 前綴之後已完成的塊（相對 first）
+    atomic<long long> limit;    // 絕對塊號上限：≥ 此塊號不再發
+
+    static double se(const Stats &s) { return sqrt(spinRtpVar(s) / (double)s.nSpins); }
+
+    // 持鎖呼叫：盡量延長連續前綴並檢查停止條件
+    void advance()
+    {
+        const size_t lim = (size_t)(limit.load(memory_order_relaxed) - first);
+        while (!met && prefix < lim && !pending.empty() && pending.begin()->first == prefix)
+        {
+            const Tally &t = pending.begin()->second;
+            if (t.st.maxSingleSpin > acc.st.maxSingleSpin)
+                top = prefix;
+            acc.merge(t);
+            pending.erase(pending.begin());
+            prefix++;
+            if (targetSE <= 0)
+                continue;
+            bool ok = acc.st.triggerCount >= minTriggers && acc.st.nSpins >= minSpins && se(acc.st) <= targetSE;
+            if (!ok)
+            {
+                candidate = 0;
+                continue;
+            }
+            if (candidate == 0)
+                candidate = prefix;
+            if (prefix >= candidate + max(MIN_CONFIRM_CHUNKS, candidate / 10))
+            {
+                met = true;
+                limit.store(first + (long long)prefix, memory_order_release);
+            }
+        }
+    }
+
+public:
+    bool met = false;
+
+    ChunkLedger(long long a, long long b) : first(a), limit(b) {}
+    long long chunkLimit() const { return limit.load(memory_order_acquire); }
+
+    // 續跑：檢查點的前綴累計與亂序塊（已完成的塊可能就已達標）
+    void restore(size_t p, const Tally &t, size_t topChunk, const map<size_t, Tally> &pend)
+    {
+        lock_guard<mutex> lk(m);
+        prefix = p;
+        acc = t;
+        top = topChunk;
+        pending = pend;
+        advance();
+    }
+
+    // 一塊完成（slot 相對 first）；達標後才完成的超跑塊直接捨棄
+    void complete(size_t slot, const Tally &t)
+    {
+        lock_guard<mutex> lk(m);
+        if (first + (long long)slot >= limit.load(memory_order_relaxed))
+        {
+            dropped++;
+            return;
+        }
+        pending.emplace(slot, t);
+        advance();
+    }
+
+    // 檢查點用的一致快照
+    void snapshot(size_t &p, Tally &t, size_t &topChunk, vector<pair<size_t, Tally>> &pend) const
+    {
+        lock_guard<mutex> lk(m);
+        p = prefix;
+        t = acc;
+        topChunk = top;
+        pend.assign(pending.begin(), pending.end());
+    }
+
+    // 以下於所有 worker join 後讀取
+    size_t prefixChunks() const { return prefix; }
+    const Tally &prefixTally() const { return acc; }
+    size_t topChunk() const { return top; }
+    size_t discarded() const { return pending.size() + dropped; } // 前綴之後已跑完但捨棄的塊
+    static double prefixSE(const Stats &s) { return s.nSpins ? se(s) : 0.0; }
+};
+
+/**************
+ * 檢查點（--checkpoint FILE [--checkpoint-every SEC]；--resume FILE 續跑）
+ * 檔案：標頭（seed/spins/chunk/rng/塊範圍）+ 完成位元圖 + 連續前綴的合併 Tally + 前綴之後已完成塊的 Tally（依塊號）
+ * 每塊的亂數子流只由 (seed, 塊號) 決定，故「塊邊界」即亂數位置：未完成的塊續跑時從頭重跑，
+ * 結果與不中斷的一次跑完逐位元相同
+ * 背景執行緒定時向 ChunkLedger 取快照（持鎖時間只有前綴與亂序塊的複製），序列化後寫暫存檔再 rename 取代，
+ * 轉數迴圈不等待 I/O；檔案大小與已跑塊數無關
+ **************/
+static string checkpointPath;       // 空 = 不寫檢查點
+static double checkpointEverySec = 60;
+static string resumePath;           // --resume
+
+static const char CKPT_MAGIC[8] = {'S', 'L', 'O', 'T', 'C', 'K', 'P', 'T'};
+static const uint32_t CKPT_VERSION = 1;
+static const uint32_t CKPT_BREAKDOWN = 1; // 旗標：各 Tally 後接 LineBreakdown
+
+struct CkptHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t statsSize; // sizeof(Stats)：欄位變動時拒絕載入
+    uint64_t seed;
+    int64_t spins, chunk, first, last; // 轉數、每塊轉數、塊範圍 [first, last)
+    uint32_t rng;
+    uint32_t distSize; // sizeof(WinDist)
+    int64_t prefix;  // 連續完成的塊數（位元圖前段全為 1）
+    int64_t top;     // 前綴中單把最高所在塊（相對 first）
+    int64_t pending; // 前綴 Tally 之後接的亂序塊 Tally 筆數
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+// 續跑狀態：依塊號（相對 first）的完成旗標、前綴累計與亂序塊
+static vector<uint8_t> resumeDone;
+static size_t resumePrefix = 0, resumeTop = 0;
+static Tally resumePrefixTally{};
+static map<size_t, Tally> resumePending;
+
+static void appendBytes(vector<char> &buf, const void *p, size_t n)
+{
+    const char *c = (const char *)p;
+    buf.insert(buf.end(), c, c + n);
+}
+
+// Tally 序列化（檢查點與分片共用）：Stats、WinDist，br 為真（檔頭旗標）時再接 LineBreakdown
+static void appendTally(vector<char> &buf, const Tally &t, bool br)
+{
+    static const LineBreakdown none{};
+    appendBytes(buf, &t.st, sizeof(Stats));
+    appendBytes(buf, &t.dist, sizeof(WinDist));
+    if (br)
+        appendBytes(buf, t.br ? t.br.get() : &none, sizeof(LineBreakdown));
+}
+
+static bool readTally(FILE *f, Tally &t, bool br)
+{
+    bool ok = fread(&t.st, sizeof(Stats), 1, f) == 1 && fread(&t.dist, sizeof(WinDist), 1, f) == 1;
+    t.br.reset(br ? new LineBreakdown() : nullptr);
+    return ok && (!br || fread(t.br.get(), sizeof(LineBreakdown), 1, f) == 1);
+}
+
+static void serializeCheckpoint(vector<char> &buf, long long first, long long last, const ChunkLedger &ledger)
+{
+    size_t prefix = 0, top = 0;
+    unique_ptr<Tally> acc(new Tally);
+    vector<pair<size_t, Tally>> pend;
+    ledger.snapshot(prefix, *acc, top, pend);
+
+    const size_t n = (size_t)(last - first);
+    vector<uint8_t> bits((n + 7) / 8, 0);
+    for (size_t i = 0; i < prefix; i++)
+        bits[i >> 3] |= (uint8_t)(1u << (i & 7));
+    for (const auto &p : pend)
+        bits[p.first >> 3] |= (uint8_t)(1u << (p.first & 7));
+
+    CkptHeader h{};
+    memcpy(h.magic, CKPT_MAGIC, sizeof(h.magic));
+    h.version = CKPT_VERSION;
+    h.statsSize = (uint32_t)sizeof(Stats);
+    h.seed = runSeed;
+    h.spins = numSpins;
+    h.chunk = chunkSpins;
+    h.first = first;
+    h.last = last;
+    h.rng = (uint32_t)rngKind;
+    h.distSize = (uint32_t)sizeof(WinDist);
+    h.prefix = (int64_t)prefix;
+    h.top = (int64_t)top;
+    h.pending = (int64_t)pend.size();
+    h.flags = breakdownMode ? CKPT_BREAKDOWN : 0;
+
+    buf.clear();
+    appendBytes(buf, &h, sizeof(h));
+    appendBytes(buf, bits.data(), bits.size());
+    appendTally(buf, *acc, breakdownMode);
+    for (const auto &p : pend)
+        appendTally(buf, p.second, breakdownMode);
+}
+
+// 讀檢查點：還原 seed/spins/chunk/rng/--breakdown/塊範圍與已完成塊；失敗時丟 runtime_error
+static void loadCheckpoint(const string &path)
+{
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f)
+        throw runtime_error("無法開啟檢查點 " + path);
+    CkptHeader h{};
+    bool ok = fread(&h, sizeof(h), 1, f) == 1 && memcmp(h.magic, CKPT_MAGIC, sizeof(h.magic)) == 0;
+    if (ok && (h.version != CKPT_VERSION || h.statsSize != sizeof(Stats) || h.distSize != sizeof(WinDist)))
+    {
+        fclose(f);
+        throw runtime_error("檢查點版本或 Stats 佈局不符（請用同一版程式續跑）");
+    }
+    size_t n = ok && h.last >= h.first ? (size_t)(h.last - h.first) : 0;
+    ok = ok && h.prefix >= 0 && (size_t)h.prefix <= n && h.top >= 0 && h.pending >= 0;
+    vector<uint8_t> bits((n + 7) / 8);
+    ok = ok && (bits.empty() || fread(bits.data(), 1, bits.size(), f) == bits.size());
+    const bool br = (h.flags & CKPT_BREAKDOWN) != 0;
+    ok = ok && readTally(f, resumePrefixTally, br);
+    resumeDone.assign(n, 0);
+    resumePending.clear();
+    for (size_t i = 0; ok && i < n; i++)
+    {
+        if (!((bits[i >> 3] >> (i & 7)) & 1))
+        {
+            ok = i >= (size_t)h.prefix;
+            continue;
+        }
+        resumeDone[i] = 1;
+        if (i >= (size_t)h.prefix)
+            ok = readTally(f, resumePending[i], br);
+    }
+    fclose(f);
+    if (!ok || (int64_t)resumePending.size() != h.pending)
+        throw runtime_error("檢查點檔案損毀 " + path);
+    resumePrefix = (size_t)h.prefix;
+    resumeTop = (size_t)h.top;
+
+    runSeed = h.seed;
+    seedGiven = true;
+    numSpins = h.spins;
+    chunkSpins = h.chunk;
+    chunkFirst = h.first;
+    chunkLast = h.last;
+    rngKind = (RngKind)h.rng;
+    breakdownMode = br;
+    if (br)
+        evalEngine = EvalEngine::Window; // column 引擎不產生視窗
+    std::fprintf(stderr, "[CKPT] 續跑 %s | seed=%llu | 已完成 %lld/%zu 塊（連續前綴 %lld）\n", path.c_str(),
+                 (unsigned long long)h.seed, (long long)(h.prefix + h.pending), n, (long long)h.prefix);
+}
+
+// 背景寫檢查點：每 checkpointEverySec 秒一次，結束時再寫最後一次
+class CheckpointWriter
+{
+    thread th;
+    mutex m;
+    condition_variable cv;
+    bool stopping = false;
+
+public:
+    CheckpointWriter(long long first, long long last, const ChunkLedger &ledger)
+    {
+        if (checkpointPath.empty())
+            return;
+        th = thread([=, &ledger]()
+                    {
+            vector<char> buf; // 每次重用同一塊記憶體
+            bool last_ = false;
+            while (!last_)
+            {
+                {
+                    unique_lock<mutex> lk(m);
+                    last_ = cv.wait_for(lk, chrono::duration<double>(checkpointEverySec), [&]
+                                        { return stopping; });
+                }
+                serializeCheckpoint(buf, first, last, ledger);
+                if (!writeFileAtomic(checkpointPath, buf))
+                    std::fprintf(stderr, "[CKPT] 寫入失敗：%s\n", checkpointPath.c_str());
+            } });
+    }
+    ~CheckpointWriter()
+    {
+        if (!th.joinable())
+            return;
+        {
+            lock_guard<mutex> lk(m);
+            stopping = true;
+        }
+        cv.notify_one();
+        th.join();
+    }
+};
+
+/**************
+ * 分片（--shard i/N [--shard-out FILE]；--merge FILE... 合併）
+ * 總塊數依塊號均分成 N 段，第 i 段即 --chunk-range 的 [i·C/N, (i+1)·C/N)；各塊子流只由 (seed, 塊號) 決定，
+ * 故各分片亂數不重疊，可分散到多台機器或多個綁核行程
+ * 分片檔：標頭（seed/spins/chunk/rng/遊戲雜湊/塊範圍/分片號/執行設定）+ 範圍內依塊號合併的 Tally（Stats 與分佈直方圖）
+ * 合併時依塊號排序各分片再 mergeStats（統計全為整數），報表與單機一次跑完逐位元相同
+ **************/
+static int shardIndex = -1, shardCount = 0; // -1 = 非分片模式
+static string shardOutPath;                 // 空 = shard-<i>-of-<N>.shard
+static vector<string> mergePaths;           // --merge（可重複）
+
+static const char SHARD_MAGIC[8] = {'S', 'L', 'O', 'T', 'S', 'H', 'R', 'D'};
+static const uint32_t SHARD_VERSION = 1;
+
+static const uint32_t SHARD_BREAKDOWN = 1; // 旗標：Tally 後接 LineBreakdown
+static const uint32_t SHARD_FG_CACHE = 2;  // 旗標：FG 以快取抽樣（與實跑 FG 的分片不可混合）
+
+struct ShardHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t statsSize; // sizeof(Stats)：欄位變動時拒絕載入
+    uint64_t seed;
+    uint64_t gameKey; // 遊戲定義雜湊：合併時拒絕不同變體的分片
+    int64_t spins, chunk, first, last;
+    uint32_t rng, flags;
+    int32_t shard, shards;
+    uint32_t distSize; // sizeof(WinDist)
+    // 產生分片時的執行設定（不影響結果，只供合併報表標頭）
+    uint32_t engine, kernel, sched; // EvalEngine、實際使用的 LineKernel、Sched
+    int32_t workers, batch;
+};
+
+// --merge 報表標頭：合併的分片數；各分片執行設定不一致時標頭只寫「merged from N shards」
+static int mergedShards = 0;
+static bool mergedMixed = false;
+
+// 完整遊戲定義雜湊（MG/FG 輪帶、賠率、線圖、倍率、轉數、線注）
+static uint64_t gameKey(const GameDef &d)
+{
+    uint64_t h = fgCacheKey(d);
+    h = fnv1a(h, d.reels[MG].sym, sizeof(d.reels[MG].sym));
+    h = fnv1a(h, d.reels[MG].len, sizeof(d.reels[MG].len));
+    h = fnv1a(h, d.pay[MG].data(), sizeof(d.pay[MG]));
+    h = fnv1a(h, d.fgMul, sizeof(d.fgMul));
+    h = fnv1a(h, d.tierEdge, sizeof(d.tierEdge));
+    return h;
+}
+
+static string shardOutput()
+{
+    if (!shardOutPath.empty())
+        return shardOutPath;
+    return "shard-" + to_string(shardIndex) + "-of-" + to_string(shardCount) + ".shard";
+}
+
+static bool writeShard(const Game &g, long long first, long long last, const Tally &total)
+{
+    ShardHeader h{};
+    memcpy(h.magic, SHARD_MAGIC, sizeof(h.magic));
+    h.version = SHARD_VERSION;
+    h.statsSize = (uint32_t)sizeof(Stats);
+    h.seed = runSeed;
+    h.gameKey = gameKey(g.def);
+    h.spins = numSpins;
+    h.chunk = chunkSpins;
+    h.first = first;
+    h.last = last;
+    h.rng = (uint32_t)rngKind;
+    h.flags = (breakdownMode ? SHARD_BREAKDOWN : 0) | (g.fgCache ? SHARD_FG_CACHE : 0);
+    h.shard = shardIndex;
+    h.shards = shardCount;
+    h.distSize = (uint32_t)sizeof(WinDist);
+    h.engine = (uint32_t)evalEngine;
+    h.kernel = (uint32_t)lineKernel;
+    h.sched = (uint32_t)schedMode;
+    h.workers = numWorkers;
+    h.batch = batchSize;
+
+    vector<char> buf;
+    appendBytes(buf, &h, sizeof(h));
+    appendTally(buf, total, breakdownMode);
+    const string path = shardOutput();
+    if (!writeFileAtomic(path, buf))
+    {
+        std::fprintf(stderr, "[SHARD] 寫入失敗：%s\n", path.c_str());
+        return false;
+    }
+    std::fprintf(stderr, "[SHARD] 分片 %d/%d | 塊 [%lld, %lld) | 已寫入 %s\n", shardIndex, shardCount,
+                 (long long)h.first, (long long)h.last, path.c_str());
+    return true;
+}
+
+struct ShardFile
+{
+    string path;
+    ShardHeader h;
+    Tally total;
+};
+
+// 讀分片檔；失敗時丟 runtime_error
+static ShardFile loadShard(const string &path)
+{
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f)
+        throw runtime_error("無法開啟分片 " + path);
+    ShardFile s{path, {}, {}};
+    bool ok = fread(&s.h, sizeof(s.h), 1, f) == 1 && memcmp(s.h.magic, SHARD_MAGIC, sizeof(s.h.magic)) == 0;
+    if (ok && (s.h.version != SHARD_VERSION || s.h.statsSize != sizeof(Stats) || s.h.distSize != sizeof(WinDist)))
+    {
+        fclose(f);
+        throw runtime_error("分片版本或 Stats 佈局不符（請用同一版程式合併）：" + path);
+    }
+    ok = ok && s.h.last >= s.h.first && s.h.chunk > 0 && readTally(f, s.total, (s.h.flags & SHARD_BREAKDOWN) != 0);
+    fclose(f);
+    if (!ok)
+        throw runtime_error("分片檔案損毀 " + path);
+    return s;
+}
+
+#ifdef SLOT_PROFILE
+// 剖析輸出：各 worker spins/s 與 MG/FG 時間占比，合併後的 FG 串長/代數分佈
+static void printProfile(const vector<WorkerReport> &rep)
+{
+#ifdef SLOT_X86
+    const char *unit = "Mtsc";
+#else
+    const char *unit = "Mns";
+#endif
+    PhaseProfile all;
+    for (size_t i = 0; i < rep.size(); i++)
+    {
+        const PhaseProfile &p = rep[i].prof;
+        const double mg = (double)(p.chunkTicks - min(p.chunkTicks, p.fgTicks));
+        std::fprintf(stderr, "[PROF]  worker %-3zu | %.0f spins/s | MG %.1f %s (%.1f%%, %.1f/轉) | FG %.1f %s (%.1f%%, %.1f/串 × %lld 串)\n",
+                     i, rep[i].busySec > 0 ? (double)p.spins / rep[i].busySec : 0.0, mg * 1e-6, unit,
+                     p.chunkTicks ? 100.0 * mg / (double)p.chunkTicks : 0.0, p.spins ? mg / (double)p.spins : 0.0,
+                     (double)p.fgTicks * 1e-6, unit, p.chunkTicks ? 100.0 * (double)p.fgTicks / (double)p.chunkTicks : 0.0,
+                     p.sessions ? (double)p.fgTicks / (double)p.sessions : 0.0, p.sessions);
+        all.merge(p);
+    }
+    if (all.sessions == 0)
+        return;
+    std::fprintf(stderr, "[PROF] 合計 FG 時間占比 %.1f%% | %lld 串 | 最長一串 %d 轉\n",
+                 all.chunkTicks ? 100.0 * (double)all.fgTicks / (double)all.chunkTicks : 0.0, all.sessions, all.longest);
+    std::fprintf(stderr, "[PROF] FG 串長（再觸發次數 k，轉數 = fgSpins × (k+1) : 串數 / 占比）\n");
+    for (int k = 0; k < PhaseProfile::RETRI_BINS; k++)
+        if (all.retriHist[k])
+            std::fprintf(stderr, "[PROF]   %s%-3d : %-12lld %.6f%%\n", k == PhaseProfile::RETRI_BINS - 1 ? "≥" : " ", k,
+                         all.retriHist[k], 100.0 * (double)all.retriHist[k] / (double)all.sessions);
+    if (all.depthKnown == 0)
+        return;
+    std::fprintf(stderr, "[PROF] 再觸發代數（代數 : 串數 / 占比）\n");
+    for (int k = 0; k < PhaseProfile::DEPTH_BINS; k++)
+        if (all.depthHist[k])
+            std::fprintf(stderr, "[PROF]   %s%-3d : %-12lld %.6f%%\n", k == PhaseProfile::DEPTH_BINS - 1 ? "≥" : " ", k,
+                         all.depthHist[k], 100.0 * (double)all.depthHist[k] / (double)all.depthKnown);
+}
+#endif
+
+// 跑一塊：子流與 Stats 都只看塊號（不看遊戲，故多遊戲同塊號共用同一段亂數）；out 先清空再累計
+template <class Rng, class Probe = NoProbe>
+static void runChunk(const Game &g, long long c, long long n, Window5x3 *w, SpinBlock *B, Tally &out,
+                     LiveSlot *live = nullptr, const Stats *acc = nullptr)
+{
+    Rng rngMG = makeStream<Rng>(runSeed, chunkStreamMG(c));
+    Rng rngFG = makeStream<Rng>(runSeed, chunkStreamFG(c));
+    out.st = Stats{};
+    out.dist = WinDist{};
+    if constexpr (Probe::on)
+    {
+        if (!out.br)
+            out.br.reset(new LineBreakdown());
+        *out.br = LineBreakdown{};
+    }
+    runSpins<Probe>(g, rngMG, rngFG, w, B, n, out.st, out.dist, Probe(out.br.get(), 1), live, acc);
+}
+
+template <class Rng, class Probe>
+static void stealWorker(int id, ChunkScheduler &S, vector<unique_ptr<ChunkLedger>> &runs, long long first, size_t chunks,
+                        int cpu, WorkerReport *rep)
+{
+    if (cpu >= 0 && pinCurrentThread(cpu))
+        rep->cpu = cpu;
+
+    Window5x3 w{};
+    unique_ptr<SpinBlock> B;
+    if (batchSize > 0)
+        B.reset(new SpinBlock((size_t)batchSize));
+
+    const size_t G = runs.size();
+    auto drop = [&](long long j)
+    {
+        auto [k, slot] = jobOf(j, G, chunks);
+        return first + (long long)slot >= runs[k]->chunkLimit();
+    };
+
+    // 即時快照只在單一遊戲時有意義（多遊戲混算 RTP 無解讀價值）
+    LiveSlot *live = G == 1 && id < liveSlotCount ? &liveSlots[id] : nullptr;
+    Stats acc{};                        // 本 worker 已完成塊的累計（僅供即時快照）
+    unique_ptr<Tally> chunk(new Tally); // 本塊結果（完成後交給 ChunkLedger）
+    bool stolen = false;
+    for (long long j; (j = S.next(id, stolen, drop)) >= 0;)
+    {
+        auto t0 = chrono::steady_clock::now();
+        auto [k, slot] = jobOf(j, G, chunks);
+        long long c = first + (long long)slot;
+        long long n = chunkLen(c);
+#ifdef SLOT_PROFILE
+        const uint64_t c0 = profTicks();
+        runChunk<Rng, Probe>(*games[k], c, n, &w, B.get(), *chunk, live, &acc);
+        profLocal.chunkTicks += profTicks() - c0;
+        profLocal.spins += n;
+#else
+        runChunk<Rng, Probe>(*games[k], c, n, &w, B.get(), *chunk, live, &acc);
+#endif
+        runs[k]->complete(slot, *chunk);
+        if (live)
+        {
+            mergeStats(acc, chunk->st);
+            live->publish(acc, Stats{});
+        }
+        rep->busySec += chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        rep->spins += n;
+        rep->chunks++;
+        rep->stolen += stolen ? 1 : 0;
+    }
+#ifdef SLOT_PROFILE
+    rep->prof = profLocal;
+#endif
+}
+
+// 回傳每個遊戲依塊號順序合併的總計（達標時只含前綴），與 thread 數無關
+template <class Rng, class Probe = NoProbe>
+static vector<Tally> runScheduled()
+{
+    auto [a, b] = chunkRange();
+    const size_t n = (size_t)(b - a), G = games.size();
+    vector<unique_ptr<ChunkLedger>> runs(G);
+    for (auto &r : runs)
+        r.reset(new ChunkLedger(a, b));
+    if (G == 1 && !resumeDone.empty()) // 檢查點只支援單一遊戲
+        runs[0]->restore(resumePrefix, resumePrefixTally, resumeTop, resumePending);
+    ChunkScheduler S(numWorkers, (long long)(G * n), schedMode == Sched::Steal, resumeDone);
+    vector<WorkerReport> rep(numWorkers);
+    vector<int> cpus = affinityCpus();
+
+    auto t0 = chrono::steady_clock::now();
+    {
+        CheckpointWriter ckpt(a, b, *runs[0]); // 解構時寫最後一次並 join
+        vector<thread> threads;
+        for (int i = 0; i < numWorkers; i++)
+        {
+            int cpu = cpus.empty() ? -1 : cpus[(size_t)i % cpus.size()];
+            threads.emplace_back([&, i, cpu]()
+                                 { stealWorker<Rng, Probe>(i, S, runs, a, n, cpu, &rep[i]); });
+        }
+        for (auto &th : threads)
+            th.join();
+    }
+    double wall = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    static const char *affName[] = {"無", "全部邏輯核心", "僅實體核心"};
+    std::fprintf(stderr, "[SCHED] 塊 [%lld, %lld) × %lld 轉 | %zu 遊戲%s | %d workers | 綁核：%s | 牆鐘 %.2fs\n",
+                 a, b, chunkSpins, G, G > 1 ? (interleaveGames ? "（交錯）" : "（依序）") : "", numWorkers,
+                 affName[(int)affinityMode], wall);
+    for (int i = 0; i < numWorkers; i++)
+    {
+        WorkerReport &r = rep[i];
+        r.idleSec = max(0.0, wall - r.busySec);
+        std::fprintf(stderr, "[SCHED]   worker %-3d cpu=%-3d | spins %-12lld | 塊 %-5lld (偷 %-4lld) | 忙碌 %.2fs | 閒置 %.2fs\n",
+                     i, r.cpu, r.spins, r.chunks, r.stolen, r.busySec, r.idleSec);
+    }
+#ifdef SLOT_PROFILE
+    printProfile(rep);
+#endif
+
+    vector<Tally> out(G);
+    for (size_t k = 0; k < G; k++)
+    {
+        const ChunkLedger &r = *runs[k];
+        const char *tag = games[k]->def.name.c_str();
+        const Stats &p = r.prefixTally().st;
+        if (targetSE > 0)
+        {
+            if (r.met)
+                std::fprintf(stderr, "[ADAPT] %s 達標：前 %zu 塊 %lld 轉 | SE %.6f ≤ %.6f | 觸發 %lld | 捨棄超跑 %zu 塊\n",
+                             tag, r.prefixChunks(), p.nSpins, ChunkLedger::prefixSE(p), targetSE, p.triggerCount,
+                             r.discarded());
+            else
+                std::fprintf(stderr, "[ADAPT] %s 未達標：已跑滿上限 %lld 轉 | SE %.6f（目標 %.6f）| 觸發 %lld\n",
+                             tag, p.nSpins, ChunkLedger::prefixSE(p), targetSE, p.triggerCount);
+        }
+
+        // 單把最高所在塊：可用 --chunk-range 直接重跑該區段
+        const long long top = a + (long long)r.topChunk();
+        if (r.prefixChunks() > 0)
+            std::fprintf(stderr, "[SEED] %s seed=%llu | 單把最高 %.2f 位於塊 %lld（重跑：--seed %llu --chunk %lld --chunk-range %lld:%lld）\n",
+                         tag, (unsigned long long)runSeed, (double)p.maxSingleSpin * betPerLine, top,
+                         (unsigned long long)runSeed, chunkSpins, top, top + 1);
+        out[k] = r.prefixTally();
+    }
+    return out;
+}
+
+/**************
+ * 參數掃描（--sweep FILE…）：基準遊戲（內建或單一 --game）＋多個變體，共用同一組停點（common random numbers）
+ *   每把 MG 只抽一次 5 軸原始亂數 u_r，各變體依自身輪帶長度取停點 ⌊u_r·L / 2^32⌋（不拒絕，偏差 < L/2^32），
+ *   填窗、算線獎與 S；觸發的變體各自從同一個 FG 流狀態起跑（長度相同的 FG 輪帶即抽到相同停點），
+ *   本把結束後 FG 流前進到消耗最多的那個變體之後，故同一變體的各把 FG 不會重用亂數
+ *   配對差 d = RTP_k − RTP_基準 逐把累計，其 CI 遠窄於兩次獨立模擬相減
+ * 塊與子流同排程模式（依塊號合併），結果與 thread 數無關；停點映射不同，基準數值不與一般模式逐位元相同
+ **************/
+static double sweepTarget = -1; // --sweep-target：依 |RTP − 目標| 排名；負值 = 依 RTP 由高到低
+
+struct SweepStats
+{
+    Stats s;
+    double diffSum = 0, diffSumSq = 0; // 與基準的逐把 RTP 差
+};
+
+// 計數轉接：記下 FG 用掉幾個亂數，以找出消耗最多的變體
+template <class Rng>
+struct CountedRng
+{
+    Rng r;
+    uint64_t n = 0;
+    uint64_t operator()()
+    {
+        n++;
+        return r();
+    }
+};
+
+template <class Rng>
+static void runSweepChunk(long long c, long long n, Window5x3 *w, vector<SweepStats> &out, vector<long long> &spinWin,
+                          WinDist &dist)
+{
+    Rng rngMG = makeStream<Rng>(runSeed, chunkStreamMG(c));
+    Rng rngFG = makeStream<Rng>(runSeed, chunkStreamFG(c));
+    const size_t G = games.size();
+    out.assign(G, SweepStats{});
+    long long bumpCnt = 0;
+    for (long long i = 0; i < n; i++)
+    {
+        uint32_t u[5];
+        for (int r = 0; r < 5; r++)
+            u[r] = (uint32_t)(rngMG() >> 32);
+
+        CountedRng<Rng> far{rngFG}; // 本把消耗最多的 FG 流
+        for (size_t k = 0; k < G; k++)
+        {
+            const Game &g = *games[k];
+            const ReelSet &R = g.def.reels[MG];
+            for (int r = 0; r < 5; r++)
+                memcpy(w->c[r], &R.sym[r][((uint64_t)u[r] * (uint32_t)R.len[r]) >> 32], 3);
+            const long long mgLine = evalLines<MG>(g.def, g.bb[MG], w);
+            int s = countScatter(w);
+            if (s >= 3)
+            {
+                CountedRng<Rng> fg{rngFG};
+                spinWin[k] = finishSpin(g, fg, w, mgLine, s, out[k].s, dist);
+                if (fg.n > far.n)
+                    far = fg;
+            }
+            else
+                spinWin[k] = finishSpin(g, rngFG, w, mgLine, s, out[k].s, dist);
+        }
+        if (far.n > 0)
+            rngFG = far.r;
+        for (size_t k = 1; k < G; k++)
+        {
+            double d = (double)(spinWin[k] - spinWin[0]) / numLines;
+            out[k].diffSum += d;
+            out[k].diffSumSq += d * d;
+        }
+        if (++bumpCnt == 4096)
+        {
+            spinsDone.fetch_add(bumpCnt, memory_order_relaxed);
+            bumpCnt = 0;
+        }
+    }
+    spinsDone.fetch_add(bumpCnt, memory_order_relaxed);
+}
+
+template <class Rng>
+static vector<SweepStats> runSweep()
+{
+    auto [a, b] = chunkRange();
+    const size_t n = (size_t)(b - a), G = games.size();
+    vector<vector<SweepStats>> chunkStats(n);
+    ChunkScheduler S(numWorkers, (long long)n, schedMode == Sched::Steal, {});
+
+    auto t0 = chrono::steady_clock::now();
+    vector<thread> threads;
+    for (int i = 0; i < numWorkers; i++)
+        threads.emplace_back([&, i]()
+                             {
+            Window5x3 w{};
+            vector<long long> spinWin(G);
+            unique_ptr<WinDist> dist(new WinDist); // 掃描表不列分佈，僅供 finishSpin 寫入
+            bool stolen = false;
+            for (long long j; (j = S.next(i, stolen, [](long long) { return false; })) >= 0;)
+                runSweepChunk<Rng>(a + j, chunkLen(a + j), &w, chunkStats[(size_t)j], spinWin, *dist); });
+    for (auto &th : threads)
+        th.join();
+    double wall = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    std::fprintf(stderr, "[SWEEP] 塊 [%lld, %lld) × %lld 轉 | 基準 + %zu 變體 | %d workers | 牆鐘 %.2fs\n",
+                 a, b, chunkSpins, G - 1, numWorkers, wall);
+
+    vector<SweepStats> total(G);
+    for (const auto &cs : chunkStats)
+        for (size_t k = 0; k < G; k++)
+        {
+            mergeStats(total[k].s, cs[k].s);
+            total[k].diffSum += cs[k].diffSum;
+            total[k].diffSumSq += cs[k].diffSumSq;
+        }
+    return total;
+}
+
+// 排名表：RTP / 觸發率 / 每把 RTP 標準差，以及對基準的配對差 95% CI 與變異縮減倍數
+static void printSweep(const vector<SweepStats> &t)
+{
+    const size_t G = t.size();
+    auto rtpOf = [&](size_t k)
+    { return spinRtpMean(t[k].s); };
+    auto varOf = [&](size_t k)
+    { return spinRtpVar(t[k].s); };
+
+    vector<size_t> order(G);
+    for (size_t k = 0; k < G; k++)
+        order[k] = k;
+    stable_sort(order.begin(), order.end(), [&](size_t x, size_t y)
+                { return sweepTarget >= 0 ? fabs(rtpOf(x) - sweepTarget) < fabs(rtpOf(y) - sweepTarget)
+                                          : rtpOf(x) > rtpOf(y); });
+
+    const double n = (double)t[0].s.nSpins;
+    cout << "=== Sweep | 基準=" << games[0]->def.name << " | 變體=" << G - 1 << " | spins=" << t[0].s.nSpins
+         << " | seed=" << runSeed << " | chunk=" << chunkSpins << " | rng=" << rngName(rngKind) << " | 排名依"
+         << (sweepTarget >= 0 ? "與目標 RTP 距離" : "RTP 由高到低") << " ===\n";
+    cout.setf(std::ios::fixed);
+    cout << setprecision(6);
+    for (size_t rank = 0; rank < G; rank++)
+    {
+        size_t k = order[rank];
+        const Stats &s = t[k].s;
+        cout << "#" << rank + 1 << " " << games[k]->def.name << (k == 0 ? "（基準）" : "") << "\n";
+        cout << "  RTP                   : " << rtpOf(k) << " ± " << 1.96 * sqrt(varOf(k) / n) << "\n";
+        cout << "  觸發率                : " << (double)s.triggerCount / n << " " << everyStr(s.nSpins, s.triggerCount) << "\n";
+        cout << "  每把 RTP 標準差       : " << sqrt(varOf(k)) << "\n";
+        if (k == 0)
+            continue;
+        double dm = t[k].diffSum / n;
+        double dv = max(0.0, t[k].diffSumSq / n - dm * dm);
+        double hw = 1.96 * sqrt(dv / n);
+        double indep = varOf(k) + varOf(0); // 兩次獨立模擬相減時的方差
+        cout << "  ΔRTP vs 基準（配對）  : " << dm << "  95% CI [" << dm - hw << ", " << dm + hw << "]"
+             << (dm - hw > 0 || dm + hw < 0 ? "（顯著）" : "") << "\n";
+        cout << "  變異縮減（獨立/配對） : ";
+        if (dv > 0)
+            cout << setprecision(1) << indep / dv << "×\n" << setprecision(6);
+        else
+            cout << "—（與基準逐把相同）\n";
+    }
+}
+
+/**************
+ * 精確計算（--exact）：窮舉輪帶全週期
+ * 與 worker 同樣呼叫 evalLines / countScatter，故結果可與模擬值直接比對
+ **************/
+struct ExactEnum
+{
+    unsigned long long combos = 0;            // 總組合數 = ∏ 各軸長度
+    unsigned long long deadCombos = 0;        // 無線獎且 <3S 的組合數
+    unsigned long long scatterCombos[4] = {}; // [0]=<3S、[1]=3S、[2]=4S、[3]=5S
+    // lineHist[k][v]：散佈類別 k 下，線獎總倍率（未乘線注）為 v 的組合數
+    vector<unsigned long long> lineHist[4];
+};
+
+static inline int scatterClass(int s)
+{
+    return s >= 5 ? 3 : (s >= 3 ? s - 2 : 0);
+}
+
+// 窮舉一組輪帶（MG 或 FG）；以前兩軸停點為一個工作單位分給各 thread
+// --engine column 時改以列 ID 查表求值（同一組停點，結果相同）
+template <GameMode M>
+static ExactEnum exactEnumerate(const Game &g, int workers)
+{
+    const ColumnTables &T = g.col[M];
+    const ReelSet &R = g.def.reels[M];
+    const PayTable &pay = g.def.pay[M];
+    const bool useColumns = evalEngine == EvalEngine::Column;
+    const int L0 = R.len[0], L1 = R.len[1];
+    const long long tasks = (long long)L0 * L1;
+    atomic<long long> next{0};
+    vector<ExactEnum> part(workers);
+
+    // 線獎總倍率上限：每線最高賠率 × 線數
+    int maxPay = 0;
+    for (const auto &row : pay)
+        for (int v : row)
+            maxPay = max(maxPay, v);
+    const size_t histSize = (size_t)maxPay * numLines + 1;
+
+    auto run = [&](ExactEnum *out)
+    {
+        ExactEnum loc{};
+        for (auto &h : loc.lineHist)
+            h.assign(histSize, 0);
+        Window5x3 w{};
+        for (long long t; (t = next.fetch_add(1, memory_order_relaxed)) < tasks;)
+        {
+            int s0 = (int)(t / L1), s1 = (int)(t % L1);
+            memcpy(w.c[0], &R.sym[0][s0], 3);
+            memcpy(w.c[1], &R.sym[1][s1], 3);
+            uint8_t c[5] = {};
+            if (useColumns)
+            {
+                c[0] = T.colOfStop[0][s0];
+                c[1] = T.colOfStop[1][s1];
+            }
+            for (int s2 = 0; s2 < R.len[2]; s2++)
+            {
+                memcpy(w.c[2], &R.sym[2][s2], 3);
+                for (int s3 = 0; s3 < R.len[3]; s3++)
+                {
+                    memcpy(w.c[3], &R.sym[3][s3], 3);
+                    for (int s4 = 0; s4 < R.len[4]; s4++)
+                    {
+                        memcpy(w.c[4], &R.sym[4][s4], 3);
+
+                        size_t v;
+                        int cls;
+                        if (useColumns)
+                        {
+                            c[2] = T.colOfStop[2][s2];
+                            c[3] = T.colOfStop[3][s3];
+                            c[4] = T.colOfStop[4][s4];
+                            v = (size_t)T.lineWin(c);
+                            cls = scatterClass(T.colScatter[0][c[0]] + T.colScatter[1][c[1]] + T.colScatter[2][c[2]] +
+                                               T.colScatter[3][c[3]] + T.colScatter[4][c[4]]);
+                        }
+                        else
+                        {
+                            v = (size_t)evalLines<M>(g.def, g.bb[M], &w);
+                            cls = scatterClass(countScatter(&w));
+                        }
+                        loc.lineHist[cls][v]++;
+                        loc.scatterCombos[cls]++;
+                        if (cls == 0 && v == 0)
+                            loc.deadCombos++;
+                        loc.combos++;
+                    }
+                }
+            }
+        }
+        *out = move(loc);
+    };
+
+    vector<thread> threads;
+    for (int i = 0; i < workers; i++)
+        threads.emplace_back(run, &part[i]);
+    for (auto &th : threads)
+        th.join();
+
+    // 匯總（全為整數計數，與 worker 數無關）
+    ExactEnum total{};
+    for (auto &h : total.lineHist)
+        h.assign(histSize, 0);
+    for (const auto &p : part)
+    {
+        total.combos += p.combos;
+        total.deadCombos += p.deadCombos;
+        for (int k = 0; k < 4; k++)
+        {
+            total.scatterCombos[k] += p.scatterCombos[k];
+            for (size_t v = 0; v < histSize; v++)
+                total.lineHist[k][v] += p.lineHist[k][v];
+        }
+    }
+    return total;
+}
+
+/**************
+ * FG 整串派彩分佈（--exact 第二段）
+ * 單轉 (win, 再觸發) 聯合分佈 → 一串 FG 的 base 分佈（n = 觸發/再觸發轉數，內建 5）：
+ *   T = W + 1[再觸發]·(T1+…+Tn)，整串 base = n 個獨立 T 之和
+ *   母函數：G(z) = A(z) + B(z)·G(z)^n、H(z) = G(z)^n
+ *   A/B = 不觸發/觸發時單轉 win 的分佈，以不動點迭代在截斷格點上求解（FFT 卷積）
+ * 格點單位 = 所有 FG 賠率之最大公因數（線注倍率），故離散化無誤差
+ **************/
+using cplx = complex<double>;
+
+static void fft(vector<cplx> &a, bool inverse)
+{
+    const size_t n = a.size();
+    for (size_t i = 1, j = 0; i < n; i++)
+    {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j)
+            swap(a[i], a[j]);
+    }
+    const double PI = acos(-1.0);
+    for (size_t len = 2; len <= n; len <<= 1)
+    {
+        double ang = 2 * PI / (double)len * (inverse ? -1 : 1);
+        cplx wl(cos(ang), sin(ang));
+        for (size_t i = 0; i < n; i += len)
+        {
+            cplx w(1);
+            for (size_t k = 0; k < len / 2; k++)
+            {
+                cplx u = a[i + k], v = a[i + k + len / 2] * w;
+                a[i + k] = u + v;
+                a[i + k + len / 2] = u - v;
+                w *= wl;
+            }
+        }
+    }
+    if (inverse)
+        for (auto &x : a)
+            x /= (double)n;
+}
+
+// 截斷乘積：回傳 (x·y) 的前 M 項（機率值，負的捨入噪音歸零）
+static vector<double> mulTrunc(const vector<double> &x, const vector<double> &y, size_t M)
+{
+    size_t n = 1;
+    while (n < 2 * M)
+        n <<= 1;
+    vector<cplx> fa(n), fb(n);
+    for (size_t i = 0; i < M; i++)
+    {
+        fa[i] = x[i];
+        fb[i] = y[i];
+    }
+    fft(fa, false);
+    fft(fb, false);
+    for (size_t i = 0; i < n; i++)
+        fa[i] *= fb[i];
+    fft(fa, true);
+    vector<double> r(M);
+    for (size_t i = 0; i < M; i++)
+        r[i] = max(0.0, fa[i].real());
+    return r;
+}
+
+// 截斷冪次 x^e（前 M 項；平方乘）
+static vector<double> powTrunc(const vector<double> &x, int e, size_t M)
+{
+    vector<double> r(M, 0.0), b = x;
+    r[0] = 1.0;
+    for (bool first = true; e > 0; e >>= 1)
+    {
+        if (e & 1)
+        {
+            r = first ? b : mulTrunc(r, b, M);
+            first = false;
+        }
+        if (e > 1)
+            b = mulTrunc(b, b, M);
+    }
+    return r;
+}
+
+static long long gcdLL(long long a, long long b)
+{
+    while (b)
+    {
+        long long t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static void runExact(const Game &game)
+{
+    const GameDef &d = game.def;
+    auto t0 = chrono::steady_clock::now();
+    ExactEnum mg = exactEnumerate<MG>(game, numWorkers);
+    double secsMG = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    // 線獎總倍率加總（整數，無捨入誤差）
+    unsigned long long lineUnits = 0;
+    for (int k = 0; k < 4; k++)
+        for (size_t v = 0; v < mg.lineHist[k].size(); v++)
+            lineUnits += (unsigned long long)v * mg.lineHist[k][v];
+
+    const double N = (double)mg.combos;
+    const double rtpMG = (double)lineUnits / (N * numLines); // 線注相消
+    const long long trig = (long long)(mg.scatterCombos[1] + mg.scatterCombos[2] + mg.scatterCombos[3]);
+    auto every = [&](unsigned long long c)
+    { return everyStr((long long)mg.combos, (long long)c); };
+
+    cout.setf(std::ios::fixed);
+    cout << "=== Exact | " << d.name << " | MG 全週期窮舉 | 組合數=" << mg.combos
+         << " | workers=" << numWorkers
+         << " | 耗時 " << setprecision(2) << secsMG << "s ===\n";
+    cout << setprecision(10);
+    cout << "主遊戲 RTP（精確）                    : " << rtpMG << "\n";
+    cout << "免費遊戲觸發機率                      : " << (double)trig / N
+         << " " << every(trig) << "\n";
+    for (int k = 1; k <= 3; k++)
+        cout << "  └" << left << setw(6) << mulLabel(d, k + 2) << right << "機率 (" << k + 2
+             << "S)                     : " << (double)mg.scatterCombos[k] / N << " " << every(mg.scatterCombos[k]) << "\n";
+    cout << "主遊戲 dead spins（無線獎且未觸發FG）: " << mg.deadCombos
+         << " (占比 " << (double)mg.deadCombos / N << ")\n";
+
+    // ===== FG：單轉窮舉 =====
+    t0 = chrono::steady_clock::now();
+    ExactEnum fg = exactEnumerate<FG>(game, numWorkers);
+
+    // 格點單位 g（線注倍率）：所有 FG 賠率之最大公因數
+    long long g = 0;
+    for (const auto &row : d.pay[FG])
+        for (int v : row)
+            if (v > 0)
+                g = gcdLL(g, v);
+    if (g <= 0)
+        g = 1;
+
+    // 單轉分佈：A = 無再觸發、B = 再觸發（以格點為索引）
+    const double NF = (double)fg.combos;
+    const double pRetri = (double)(fg.combos - fg.scatterCombos[0]) / NF;
+    double eW = 0, eW2 = 0, eWI = 0; // E[W]、E[W²]、E[W·1再觸發]（格點單位）
+    for (int k = 0; k < 4; k++)
+        for (size_t v = 0; v < fg.lineHist[k].size(); v++)
+            if (fg.lineHist[k][v])
+            {
+                double p = (double)fg.lineHist[k][v] / NF, x = (double)v / (double)g;
+                eW += p * x;
+                eW2 += p * x * x;
+                if (k > 0)
+                    eWI += p * x;
+            }
+
+    // 截斷長度 M：涵蓋最小倍率下最高細分門檻所需的 base，再取 2 的冪
+    const double maxEdge = HIGH_BIN_EDGES[NUM_HIGH_BINS - 1];
+    const double minMul = max(1e-9, (double)min({fgMulByScatter(d, 3), fgMulByScatter(d, 4), fgMulByScatter(d, 5)}));
+    const int n = d.fgSpins;
+    size_t M = 1;
+    while ((double)M * (double)g * minMul < maxEdge * numLines * 2.0)
+        M <<= 1;
+
+    vector<double> A(M, 0.0), B(M, 0.0);
+    for (int k = 0; k < 4; k++)
+        for (size_t v = 0; v < fg.lineHist[k].size(); v++)
+            if (fg.lineHist[k][v])
+            {
+                size_t idx = v / (size_t)g;
+                if (idx < M)
+                    (k == 0 ? A : B)[idx] += (double)fg.lineHist[k][v] / NF;
+            }
+
+    // 不動點迭代：G ← A + B·G^n；每輪誤差約乘上平均再觸發數 n·p
+    vector<double> G = A, H;
+    int iters = 0;
+    for (; iters < 200; iters++)
+    {
+        H = powTrunc(G, n, M);
+        vector<double> BH = mulTrunc(B, H, M);
+        double diff = 0;
+        for (size_t i = 0; i < M; i++)
+        {
+            double nv = A[i] + BH[i];
+            diff = max(diff, fabs(nv - G[i]));
+            G[i] = nv;
+        }
+        if (diff < 1e-18)
+            break;
+    }
+    H = powTrunc(G, n, M); // 整串 FG base 分佈（格點單位）
+    double secsFG = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    // 解析動差（不受截斷影響）：μ = E[T]、E[T²]；整串 S = n 個 T 之和
+    const double nn = (double)n;
+    const double mu = eW / (1.0 - nn * pRetri);
+    const double eT2 = (eW2 + 2.0 * nn * mu * eWI + nn * (nn - 1.0) * pRetri * mu * mu) / (1.0 - nn * pRetri);
+    const double eS = nn * mu, eS2 = nn * eT2 + nn * (nn - 1.0) * mu * mu;
+    const double eSpins = nn / (1.0 - nn * pRetri);
+
+    // H 的尾端：surv[i] = P(S ≥ i)（格點單位），超出截斷者由 1-ΣH 補上
+    vector<double> surv(M + 1, 0.0);
+    double massIn = 0;
+    for (size_t i = 0; i < M; i++)
+        massIn += H[i];
+    surv[M] = max(0.0, 1.0 - massIn);
+    for (size_t i = M; i-- > 0;)
+        surv[i] = surv[i + 1] + H[i];
+    auto survS = [&](double lineUnitsNeeded) -> double // P(S·g ≥ x)（線注倍率）
+    {
+        if (lineUnitsNeeded <= 0)
+            return 1.0;
+        double q = ceil(lineUnitsNeeded / (double)g - 1e-9);
+        return q >= (double)M ? surv[M] : surv[(size_t)q];
+    };
+
+    const double mulOf[4] = {0, (double)fgMulByScatter(d, 3), (double)fgMulByScatter(d, 4), (double)fgMulByScatter(d, 5)};
+    const double gd = (double)g;
+
+    // 單把倍率 ratio = (mg + mul·S)/lines ≥ t 的精確機率
+    auto probRatioAtLeast = [&](double t) -> double
+    {
+        double need = t * numLines, p = 0;
+        for (int k = 0; k < 4; k++)
+            for (size_t v = 0; v < mg.lineHist[k].size(); v++)
+            {
+                if (!mg.lineHist[k][v])
+                    continue;
+                double pv = (double)mg.lineHist[k][v] / N;
+                if (k == 0)
+                    p += (double)v >= need ? pv : 0.0;
+                else
+                    p += mulOf[k] > 0 ? pv * survS((need - (double)v) / mulOf[k]) : ((double)v >= need ? pv : 0.0);
+            }
+        return p;
+    };
+
+    // RTP 與每把變異（線注倍率 / 線數 = 押注倍率）
+    double rtpFG[4] = {}, eR2 = 0;
+    for (int k = 0; k < 4; k++)
+    {
+        double pk = (double)mg.scatterCombos[k] / N;
+        rtpFG[k] = pk * mulOf[k] * eS * gd / numLines;
+        for (size_t v = 0; v < mg.lineHist[k].size(); v++)
+        {
+            if (!mg.lineHist[k][v])
+                continue;
+            double pv = (double)mg.lineHist[k][v] / N, x = (double)v, m = mulOf[k] * gd;
+            eR2 += pv * (x * x + 2 * x * m * eS + m * m * eS2) / ((double)numLines * numLines);
+        }
+    }
+    const double rtpTotal = rtpMG + rtpFG[1] + rtpFG[2] + rtpFG[3];
+    const double sd = sqrt(max(0.0, eR2 - rtpTotal * rtpTotal));
+
+    cout << "\n=== Exact | FG 單轉窮舉 + 再觸發 DP | 組合數=" << fg.combos
+         << " | 格點=" << g << "×線注 | M=" << M << " | 迭代 " << iters
+         << " | 耗時 " << setprecision(2) << secsFG << "s ===\n";
+    cout << setprecision(10);
+    cout << "FG 單轉線獎期望（未乘倍率，線注倍率）: " << eW * gd << "\n";
+    cout << "FG 單轉再觸發機率                     : " << pRetri << "\n";
+    cout << "每次免費遊戲平均轉數                  : " << eSpins << "\n";
+    cout << "每串 FG base 期望值（未乘倍率）       : " << eS * gd * betPerLine
+         << "（標準差 " << sqrt(max(0.0, eS2 - eS * eS)) * gd * betPerLine << "）\n";
+    cout << "截斷外機率質量 P(base ≥ M 格)         : " << setprecision(3) << scientific << surv[M]
+         << fixed << setprecision(10) << "\n";
+    for (int k = 1; k <= 3; k++)
+        cout << "免費遊戲 RTP " << left << setw(6) << mulLabel(d, k + 2) << right << "(" << k + 2
+             << "S)                : " << rtpFG[k] << "\n";
+    cout << "免費遊戲 RTP                          : " << rtpFG[1] + rtpFG[2] + rtpFG[3] << "\n";
+    cout << "總 RTP（精確）                        : " << rtpTotal << "\n";
+    cout << "每把 RTP 標準差（精確）               : " << sd << "\n";
+    if (excelRTP >= 0 && d.builtin)
+    {
+        cout << "Excel RTP                             : " << excelRTP
+             << "（差 " << scientific << setprecision(3) << excelRTP - rtpTotal << fixed << "）\n";
+    }
+
+    auto everyP = [](double p)
+    {
+        if (p <= 0)
+            return string("（—）");
+        ostringstream oss;
+        oss << "（約每 " << llround(1.0 / p) << " 轉一次）";
+        return oss.str();
+    };
+    cout << "\n獎項分佈（精確機率）\n";
+    cout << scientific << setprecision(6);
+    for (int i = 0; i < 6; i++)
+    {
+        double p = probRatioAtLeast(d.tierEdge[i]) - (i + 1 < 6 ? probRatioAtLeast(d.tierEdge[i + 1]) : 0.0);
+        cout << tierLabel(d, i) << "                 : " << p << " " << everyP(p) << "\n";
+    }
+    cout << "\n≥1000倍大獎細分（精確機率）\n";
+    for (int bi = 0; bi < NUM_HIGH_BINS; ++bi)
+    {
+        double p = probRatioAtLeast(HIGH_BIN_EDGES[bi]) -
+                   (bi + 1 < NUM_HIGH_BINS ? probRatioAtLeast(HIGH_BIN_EDGES[bi + 1]) : 0.0);
+        cout << "≥" << setw(5) << (int)HIGH_BIN_EDGES[bi] << "×bet    : " << p << ' ' << everyP(p) << '\n';
+    }
+    cout << fixed;
+}
+
+/**************
+ * 條件蒙地卡羅（--conditional）：MG 精確、FG 模擬
+ *   MG 以 exactEnumerate 窮舉一次，得 P(線獎 = v, 散佈類別 k)；FG 一串的 base 分佈與觸發倍率無關，
+ *   故 --spins 全數用來模擬 FG 串（每串一個 base b，線注倍率），各倍率共用同一批樣本。
+ *   單把倍率 X = (L + mul_k·b)/線數，各估計量皆為 b 的函數之樣本平均（對 MG 部分已取條件期望）：
+ *     RTP：E[L]/線數（精確）+ Σ_k p_k·mul_k·b̄/線數
+ *     E[X²]：(E[L²] + 2·Σ_k mul_k·E[L·1_k]·b̄ + Σ_k p_k·mul_k²·mean(b²))/線數²，SE 以 b 的 1~4 次動差做 delta method
+ *     P(X ≥ e)：P(L ≥ e·線數, k=0)（精確）+ mean_b Σ_k P(L ≥ e·線數 − mul_k·b, k)
+ *   塊與子流同排程模式（每塊 chunk 串，用該塊 FG 子流），依塊號合併 → 結果與 thread 數無關
+ **************/
+static bool conditionalMode = false;
+
+static const int NUM_COND_EDGES = 6 + NUM_HIGH_BINS; // 獎項分層 6 級 + ≥1000 細分
+
+struct CondStats
+{
+    long long sessions = 0, fgSpins = 0, retri = 0;
+    double pw[5] = {}; // Σ b^j（j = 0..4；b 為線注倍率）
+    // 各分層/細分區間的每串條件機率之和與平方和
+    double binSum[NUM_COND_EDGES] = {}, binSq[NUM_COND_EDGES] = {};
+    double maxBase = 0;
+};
+
+// MG 精確部分：各類別 P(L ≥ i, k) 的尾端表與 RTP/二階動差需要的常數（線注倍率）
+struct CondModel
+{
+    ExactEnum mg;
+    vector<double> tail[4]; // tail[k][i] = P(L ≥ i, 類別 k)
+    double p[4] = {}, mul[4] = {};
+    double eL = 0, eL2 = 0, c1 = 0, c2 = 0, c3 = 0; // c1 = Σp·mul、c2 = Σmul·E[L·1_k]、c3 = Σp·mul²
+    double edge[NUM_COND_EDGES] = {};               // 各區間下緣（×bet）；上緣為下一項（分層與細分各自為一組）
+    double upper[NUM_COND_EDGES] = {};              // 0 = 無上緣
+
+    double tailAt(int k, double need) const
+    {
+        if (need <= 0)
+            return p[k];
+        double q = ceil(need - 1e-9);
+        return q >= (double)tail[k].size() ? 0.0 : tail[k][(size_t)q];
+    }
+    // P(X ≥ e | 本串 base = b)，k = 0 只含精確部分
+    double atLeast(double e, double b) const
+    {
+        double need = e * numLines, s = tailAt(0, need);
+        for (int k = 1; k < 4; k++)
+            s += tailAt(k, need - mul[k] * b);
+        return s;
+    }
+};
+
+static CondModel buildCondModel(const Game &game)
+{
+    CondModel m;
+    m.mg = exactEnumerate<MG>(game, numWorkers);
+    const double N = (double)m.mg.combos;
+    for (int k = 0; k < 4; k++)
+    {
+        const auto &h = m.mg.lineHist[k];
+        m.tail[k].assign(h.size() + 1, 0.0);
+        for (size_t v = h.size(); v-- > 0;)
+            m.tail[k][v] = m.tail[k][v + 1] + (double)h[v] / N;
+        m.p[k] = m.tail[k][0];
+        m.mul[k] = k == 0 ? 0.0 : fgMulByScatter(game.def, k + 2);
+        double eLk = 0;
+        for (size_t v = 0; v < h.size(); v++)
+        {
+            double pv = (double)h[v] / N, x = (double)v;
+            eLk += pv * x;
+            m.eL2 += pv * x * x;
+        }
+        m.eL += eLk;
+        m.c1 += m.p[k] * m.mul[k];
+        m.c2 += m.mul[k] * eLk;
+        m.c3 += m.p[k] * m.mul[k] * m.mul[k];
+    }
+    for (int i = 0; i < 6; i++)
+    {
+        m.edge[i] = game.def.tierEdge[i];
+        m.upper[i] = i + 1 < 6 ? game.def.tierEdge[i + 1] : 0;
+    }
+    for (int bi = 0; bi < NUM_HIGH_BINS; bi++)
+    {
+        m.edge[6 + bi] = HIGH_BIN_EDGES[bi];
+        m.upper[6 + bi] = bi + 1 < NUM_HIGH_BINS ? HIGH_BIN_EDGES[bi + 1] : 0;
+    }
+    return m;
+}
+
+template <class Rng>
+static void runCondChunk(const Game &g, const CondModel &m, long long c, long long n, Window5x3 *w, CondStats &out)
+{
+    Rng rngFG = makeStream<Rng>(runSeed, chunkStreamFG(c));
+    CondStats loc{};
+    long long bumpCnt = 0;
+    for (long long i = 0; i < n; i++)
+    {
+        auto fg = playFG(g, rngFG, w);
+        const int fgSp = get<0>(fg), retri = get<2>(fg);
+        const double b = (double)get<1>(fg); // 線注單位
+        loc.sessions++;
+        loc.fgSpins += fgSp;
+        loc.retri += retri;
+        loc.maxBase = max(loc.maxBase, b * betPerLine);
+        double bj = 1;
+        for (int j = 0; j < 5; j++, bj *= b)
+            loc.pw[j] += bj;
+        for (int e = 0; e < NUM_COND_EDGES; e++)
+        {
+            double f = m.atLeast(m.edge[e], b) - (m.upper[e] > 0 ? m.atLeast(m.upper[e], b) : 0.0);
+            loc.binSum[e] += f;
+            loc.binSq[e] += f * f;
+        }
+        if (++bumpCnt == 4096)
+        {
+            spinsDone.fetch_add(bumpCnt, memory_order_relaxed);
+            bumpCnt = 0;
+        }
+    }
+    spinsDone.fetch_add(bumpCnt, memory_order_relaxed);
+    out = loc;
+}
+
+template <class Rng>
+static void runConditional(const Game &game)
+{
+    const GameDef &d = game.def;
+    auto t0 = chrono::steady_clock::now();
+    const CondModel m = buildCondModel(game);
+    double secsMG = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    auto [a, b] = chunkRange();
+    const size_t nChunks = (size_t)(b - a);
+    vector<CondStats> chunkStats(nChunks);
+    ChunkScheduler S(numWorkers, (long long)nChunks, schedMode == Sched::Steal, {});
+    t0 = chrono::steady_clock::now();
+    vector<thread> threads;
+    for (int i = 0; i < numWorkers; i++)
+        threads.emplace_back([&, i]()
+                             {
+            Window5x3 w{};
+            bool stolen = false;
+            for (long long j; (j = S.next(i, stolen, [](long long) { return false; })) >= 0;)
+                runCondChunk<Rng>(game, m, a + j, chunkLen(a + j), &w, chunkStats[(size_t)j]); });
+    for (auto &th : threads)
+        th.join();
+    double secsFG = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    CondStats t{};
+    for (const CondStats &cs : chunkStats)
+    {
+        t.sessions += cs.sessions;
+        t.fgSpins += cs.fgSpins;
+        t.retri += cs.retri;
+        t.maxBase = max(t.maxBase, cs.maxBase);
+        for (int j = 0; j < 5; j++)
+            t.pw[j] += cs.pw[j];
+        for (int e = 0; e < NUM_COND_EDGES; e++)
+        {
+            t.binSum[e] += cs.binSum[e];
+            t.binSq[e] += cs.binSq[e];
+        }
+    }
+    if (t.sessions == 0)
+        return;
+
+    // b 的樣本動差
+    const double n = (double)t.sessions, L = (double)numLines;
+    const double m1 = t.pw[1] / n, m2 = t.pw[2] / n, m3 = t.pw[3] / n, m4 = t.pw[4] / n;
+    const double varB = max(0.0, m2 - m1 * m1), varB2 = max(0.0, m4 - m2 * m2), covBB2 = m3 - m1 * m2;
+
+    const double rtpMG = m.eL / L;
+    const double rtpFG = m.c1 * m1 / L, seFG = m.c1 * sqrt(varB / n) / L;
+    const double rtp = rtpMG + rtpFG;
+    const double eX2 = (m.eL2 + 2 * m.c2 * m1 + m.c3 * m2) / (L * L);
+    const double var = max(0.0, eX2 - rtp * rtp), sd = sqrt(var);
+    // var 估計量對 (m1, m2) 的梯度 → delta method
+    const double g1 = 2 * m.c2 / (L * L) - 2 * rtp * m.c1 / L, g2 = m.c3 / (L * L);
+    const double seVar = sqrt(max(0.0, g1 * g1 * varB + g2 * g2 * varB2 + 2 * g1 * g2 * covBB2) / n);
+    const double seSD = sd > 0 ? seVar / (2 * sd) : 0.0;
+    const double eqSpins = seFG > 0 ? var / (seFG * seFG) : 0.0; // 一般模擬達到同 SE 所需轉數
+
+    const double N = (double)m.mg.combos;
+    const unsigned long long trig = m.mg.scatterCombos[1] + m.mg.scatterCombos[2] + m.mg.scatterCombos[3];
+    cout.setf(std::ios::fixed);
+    cout << "=== Conditional MC | " << d.name << " | MG 精確（組合數=" << m.mg.combos << "，" << setprecision(2)
+         << secsMG << "s）| FG 模擬 " << t.sessions << " 串（" << secsFG << "s）| workers=" << numWorkers
+         << " | seed=" << runSeed << " | chunk=" << chunkSpins << " | rng=" << rngName(rngKind) << " ===\n";
+    cout << setprecision(10);
+    cout << "主遊戲 RTP（精確）                    : " << rtpMG << "\n";
+    cout << "免費遊戲觸發機率（精確）              : " << (double)trig / N << " " << everyStr((long long)m.mg.combos, (long long)trig) << "\n";
+    cout << "每次免費遊戲平均轉數                  : " << (double)t.fgSpins / n << "\n";
+    cout << "每串 FG base 期望值（未乘倍率）       : " << m1 * betPerLine << "（標準差 " << sqrt(varB) * betPerLine
+         << "，最高 " << setprecision(2) << t.maxBase << setprecision(10) << "）\n";
+    for (int k = 1; k <= 3; k++)
+        cout << "免費遊戲 RTP " << left << setw(6) << mulLabel(d, k + 2) << right << "(" << k + 2
+             << "S)                : " << m.p[k] * m.mul[k] * m1 / L << "\n";
+    cout << "免費遊戲 RTP                          : " << rtpFG << "\n";
+    cout << "總 RTP                                : " << rtp << "\n";
+    cout << "標準誤差 SE                           : " << seFG << "\n";
+    cout << "95% 信賴區間                         : [" << rtp - 1.96 * seFG << ", " << rtp + 1.96 * seFG << "]\n";
+    cout << "每把 RTP 標準差                       : " << sd << " ± " << 1.96 * seSD << "\n";
+    cout << setprecision(0);
+    cout << "等效一般模擬轉數（同 SE）             : " << eqSpins << "（每串 FG 約抵 " << setprecision(1)
+         << eqSpins / n << " 轉）\n";
+    cout << setprecision(10);
+    if (excelRTP >= 0 && d.builtin)
+        cout << "Excel RTP                             : " << excelRTP << "（z = " << setprecision(2)
+             << (excelRTP - rtp) / (seFG > 0 ? seFG : 1e-12) << setprecision(10) << "）\n";
+
+    auto line = [&](int e)
+    {
+        double p = t.binSum[e] / n, v = max(0.0, t.binSq[e] / n - p * p), hw = 1.96 * sqrt(v / n);
+        ostringstream oss;
+        oss << scientific << setprecision(6) << p << " ± " << setprecision(2) << hw;
+        if (p > 0)
+            oss << "（約每 " << llround(1.0 / p) << " 轉一次）";
+        return oss.str();
+    };
+    cout << "\n獎項分佈（機率 ± 95% 半寬）\n";
+    for (int i = 0; i < 6; i++)
+        cout << tierLabel(d, i) << "                 : " << line(i) << "\n";
+    cout << "\n≥1000倍大獎細分（機率 ± 95% 半寬）\n";
+    for (int bi = 0; bi < NUM_HIGH_BINS; ++bi)
+        cout << "≥" << setw(5) << (int)HIGH_BIN_EDGES[bi] << "×bet    : " << line(6 + bi) << '\n';
+    cout << fixed;
+}
+
+/**************
+ * 玩家 session 模擬（--sessions N）
+ * 每個 session 以 --bankroll B（×bet）起，每把扣一注（numLines 線注單位），直到：
+ *   餘額 ≥ --stop-win W × B（達標收手；0 = 不設）、虧損 ≥ --stop-loss L × B（停損；1 = 只在付不起時停）、
+ *   餘額付不起下一注（破產），或轉滿 --session-spins M 把
+ * 每個 session 一條獨立子流（SESSION_STREAM + 序號，MG 與 FG 共用），結果與 lane 排列、塊、thread 數無關
+ * SoA：每條 worker 同時推進 SESSION_LANES 個 session，每輪分階段 抽停點填窗 → 線獎 → 數 S → FG 與結算，
+ * 結束的 lane 立即補上塊內下一個 session；全程以整數線注單位記帳
  **************/
-struct Stats
+static long long sessionCount = 0;     // 0 = 不跑
+static double sessionBankroll = 100;   // 初始資金（×bet）
+static long long sessionMaxSpins = 1000;
+static double sessionStopWin = 2;      // 餘額達初始 × W 即收手（0 = 不設）
+static double sessionStopLoss = 1;     // 虧損達初始 × L 即收手（1 = 只在付不起時停）
+static long long sessionFirstK = 100;  // 統計前 K 把內的大獎
+static const int SESSION_LANES = 256;
+static const long long SESSION_CHUNK = 4096; // 每塊 session 數（只影響排程粒度）
+static const uint64_t SESSION_STREAM = 5ULL << 60;
+
+enum SessionEnd : uint8_t
 {
-    double mainLineWinSum = 0;    // 主遊戲線獎總和（已乘線注）
-    double freeGameWinSum = 0;    // 所有 FG 派彩（已乘倍率）
-    long long triggerCount = 0;   // 觸發 FG 次數（MG→FG）
-    long long retriggerCount = 0; // 再觸發次數（FG 內獲得 3+S）
-    long long totalFGSpins = 0;   // FG 實際總轉數
-    double maxSingleSpin = 0;     // 單把最高贏分（MG+FG）
-    long long deadSpins = 0;      // 無線獎且未觸發 FG 的轉數
+    EndWin,     // 達標
+    EndLoss,    // 停損
+    EndRuin,    // 付不起下一注
+    EndMaxSpins // 轉滿
+};
 
-    // 依最初觸發倍率分類
-    long long trigX10 = 0, trigX50 = 0, trigX100 = 0;
+struct SessionStats
+{
+    long long sessions = 0, spins = 0;
+    long long ended[4] = {};
+    long long firstK[6] = {};       // 前 K 把內出現 ≥ 各分層贏分的 session 數
+    long long wagered = 0, won = 0; // 線注單位
+    long long finalSum = 0;         // 最終餘額總和（線注單位）
+    WinHist length, finalBal, peakBal, lossTime; // 轉數、×bet、×bet、停損/破產 session 的轉數
 
-    // 大獎分層（以單把贏分/押注倍率）
-    long long bigWins = 0, megaWins = 0, superWins = 0, holyWins = 0, jumboWins = 0, jojoWins = 0;
-    long long hiWinBins[NUM_HIGH_BINS] = {};
-    // FG 5 轉批次全空統計
-    long long fgZeroBatches = 0, fgTotalBatches = 0;
+    void merge(const SessionStats &o)
+    {
+        sessions += o.sessions;
+        spins += o.spins;
+        for (int i = 0; i < 4; i++)
+            ended[i] += o.ended[i];
+        for (int i = 0; i < 6; i++)
+            firstK[i] += o.firstK[i];
+        wagered += o.wagered;
+        won += o.won;
+        finalSum += o.finalSum;
+        length.merge(o.length);
+        finalBal.merge(o.finalBal);
+        peakBal.merge(o.peakBal);
+        lossTime.merge(o.lossTime);
+    }
+};
 
-    // per-spin RTP 統計（用於變異/信賴區間）
-    double rtpSum = 0, rtpSumSq = 0;
-    long long nSpins = 0;
+// 一組 lane 的 SoA 狀態（每條 worker 一份，跨塊重用）
+template <class Rng>
+struct SessionLanes
+{
+    vector<Rng> rng;
+    vector<long long> bal, peak;
+    vector<int32_t> spins, line;
+    vector<uint8_t> scatter, tierMask;
+    vector<Window5x3> win;
+    vector<int> act; // 進行中的 lane
+
+    SessionLanes()
+        : rng(SESSION_LANES, Rng(0)), bal(SESSION_LANES), peak(SESSION_LANES), spins(SESSION_LANES),
+          line(SESSION_LANES), scatter(SESSION_LANES), tierMask(SESSION_LANES), win(SESSION_LANES) {}
 };
 
+// 跑序號 [first, first + n) 的 session
+template <class Rng>
+static void runSessionChunk(const Game &g, long long first, long long n, SessionLanes<Rng> &S, Window5x3 *fgWin,
+                            SessionStats &out)
+{
+    const GameDef &d = g.def;
+    const long long bet = numLines;
+    const long long start = max(bet, llround(sessionBankroll * (double)bet));
+    const long long winAt = sessionStopWin > 0 ? llround(sessionStopWin * (double)start) : LLONG_MAX;
+    const long long lossAt = sessionStopLoss < 1 ? start - llround(sessionStopLoss * (double)start) : LLONG_MIN;
+    long long tierAt[6]; // 分層門檻（線注單位，向上取整）
+    for (int i = 0; i < 6; i++)
+        tierAt[i] = (long long)ceil(d.tierEdge[i] * (double)bet - 1e-9);
+
+    SessionStats loc{};
+    long long next = 0;
+    auto open = [&](int l)
+    {
+        S.rng[(size_t)l] = makeStream<Rng>(runSeed, SESSION_STREAM + (uint64_t)(first + next++));
+        S.bal[(size_t)l] = S.peak[(size_t)l] = start;
+        S.spins[(size_t)l] = 0;
+        S.tierMask[(size_t)l] = 0;
+    };
+    S.act.clear();
+    for (int l = 0; l < SESSION_LANES && next < n; l++)
+    {
+        open(l);
+        S.act.push_back(l);
+    }
+
+    while (!S.act.empty())
+    {
+        for (int l : S.act)
+            spinWindow<MG>(d, S.rng[(size_t)l], &S.win[(size_t)l]);
+        for (int l : S.act)
+            S.line[(size_t)l] = evalLines<MG>(d, g.bb[MG], &S.win[(size_t)l]);
+        for (int l : S.act)
+            S.scatter[(size_t)l] = (uint8_t)countScatter(&S.win[(size_t)l]);
+
+        size_t keep = 0;
+        for (int l : S.act)
+        {
+            const size_t i = (size_t)l;
+            long long win = S.line[i];
+            if (S.scatter[i] >= 3)
+                win += get<1>(drawFG(g, S.rng[i], fgWin)) * fgMulByScatter(d, S.scatter[i]);
+            S.bal[i] += win - bet;
+            S.peak[i] = max(S.peak[i], S.bal[i]);
+            S.spins[i]++;
+            loc.wagered += bet;
+            loc.won += win;
+            if (S.spins[i] <= sessionFirstK)
+                for (int t = 0; t < 6; t++)
+                    if (win >= tierAt[t])
+                        S.tierMask[i] |= (uint8_t)(1u << t);
+
+            int end = -1;
+            if (S.bal[i] >= winAt)
+                end = EndWin;
+            else if (S.bal[i] <= lossAt)
+                end = EndLoss;
+            else if (S.bal[i] < bet)
+                end = EndRuin;
+            else if (S.spins[i] >= sessionMaxSpins)
+                end = EndMaxSpins;
+            if (end < 0)
+            {
+                S.act[keep++] = l;
+                continue;
+            }
+
+            loc.sessions++;
+            loc.spins += S.spins[i];
+            loc.ended[end]++;
+            for (int t = 0; t < 6; t++)
+                loc.firstK[t] += (S.tierMask[i] >> t) & 1;
+            loc.finalSum += S.bal[i];
+            loc.length.add((double)S.spins[i]);
+            loc.finalBal.add((double)S.bal[i] / (double)bet);
+            loc.peakBal.add((double)S.peak[i] / (double)bet);
+            if (end == EndLoss || end == EndRuin)
+                loc.lossTime.add((double)S.spins[i]);
+            if (next < n)
+            {
+                open(l);
+                S.act[keep++] = l;
+            }
+        }
+        S.act.resize(keep);
+    }
+    out = loc;
+}
+
+static void printSessions(const SessionStats &t, const GameDef &d, double secs)
+{
+    if (t.sessions == 0)
+        return;
+    const double n = (double)t.sessions;
+    auto prob = [&](long long c)
+    {
+        const double p = (double)c / n;
+        ostringstream oss;
+        oss << fixed << setprecision(6) << p << " ± " << 1.96 * sqrt(p * (1 - p) / n);
+        return oss.str();
+    };
+    auto quant = [](const WinHist &h)
+    {
+        ostringstream oss;
+        oss << fixed << setprecision(1) << h.quantile(0.1) << " / " << h.quantile(0.5) << " / " << h.quantile(0.9)
+            << " / " << h.quantile(0.99);
+        return oss.str();
+    };
+
+    cout.setf(std::ios::fixed);
+    cout << "=== Sessions | " << d.name << " | sessions=" << t.sessions << " | bankroll=" << setprecision(0)
+         << sessionBankroll << "×bet | max spins=" << sessionMaxSpins << " | stop-win=×" << setprecision(2)
+         << sessionStopWin << " | stop-loss=" << setprecision(0) << sessionStopLoss * 100 << "% | workers=" << numWorkers
+         << " | seed=" << runSeed << " | rng=" << rngName(rngKind) << " | " << setprecision(2) << secs << "s ===\n";
+    if (sessionStopWin > 0)
+        cout << "達標收手（stop-win）                  : " << prob(t.ended[EndWin]) << "\n";
+    if (sessionStopLoss < 1)
+        cout << "觸及停損                              : " << prob(t.ended[EndLoss]) << "\n";
+    cout << "破產（付不起下一注）                  : " << prob(t.ended[EndRuin]) << "\n";
+    cout << "轉滿上限                              : " << prob(t.ended[EndMaxSpins]) << "\n";
+    cout << setprecision(2);
+    cout << "平均 session 長度（轉）               : " << (double)t.spins / n << "\n";
+    cout << "平均最終餘額（×bet）                  : " << (double)t.finalSum / n / numLines << "\n";
+    cout << setprecision(6);
+    cout << "session 內 RTP（總贏分 / 總押注）     : " << (double)t.won / (double)max(1LL, t.wagered) << "\n";
+
+    cout << "\n分佈（P10 / P50 / P90 / P99）\n";
+    cout << "session 長度（轉）                    : " << quant(t.length) << "\n";
+    cout << "最終餘額（×bet）                      : " << quant(t.finalBal) << "\n";
+    cout << "峰值餘額（×bet）                      : " << quant(t.peakBal) << "\n";
+    if (t.lossTime.total())
+        cout << "停損/破產所需轉數                     : " << quant(t.lossTime) << "\n";
+
+    cout << "\n前 " << sessionFirstK << " 把內出現大獎的 session 比例\n";
+    for (int i = 0; i < 6; i++)
+        cout << tierLabel(d, i) << "                 : " << prob(t.firstK[i]) << "\n";
+}
+
+template <class Rng>
+static void runSessions(const Game &g)
+{
+    const long long nChunks = (sessionCount + SESSION_CHUNK - 1) / SESSION_CHUNK;
+    vector<SessionStats> chunkStats((size_t)nChunks);
+    ChunkScheduler S(numWorkers, nChunks, schedMode == Sched::Steal, {});
+    auto t0 = chrono::steady_clock::now();
+    vector<thread> threads;
+    for (int i = 0; i < numWorkers; i++)
+        threads.emplace_back([&, i]()
+                             {
+            unique_ptr<SessionLanes<Rng>> lanes(new SessionLanes<Rng>);
+            Window5x3 w{};
+            bool stolen = false;
+            for (long long j; (j = S.next(i, stolen, [](long long) { return false; })) >= 0;)
+            {
+                const long long first = j * SESSION_CHUNK;
+                runSessionChunk<Rng>(g, first, min(SESSION_CHUNK, sessionCount - first), *lanes, &w,
+                                     chunkStats[(size_t)j]);
+            } });
+    for (auto &th : threads)
+        th.join();
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    SessionStats t{};
+    for (const SessionStats &cs : chunkStats)
+        t.merge(cs);
+    printSessions(t, g.def, secs);
+}
+
 /**************
- * 進度心跳（每秒報告；主迴圈每 4096 轉才 atomic 累加）
+ * 單把服務模式（--serve：stdin 讀請求、stdout 回應；--serve-socket PATH：Unix socket，每連線一條執行緒）
+ * 每行一個請求：首字為整數 K 時以 (seed, K) 導出的子流重算（同 --seed 與 K 必得同一結果，供稽核重放），
+ * 其他（空行、spin）取該連線自有子流的下一把；每個請求回一行 JSON：
+ *   {"key":K|null,"stops":[5 停點],"scatter":S,"mg":MG 線獎,"mul":倍率,"fg_spins":n,"fg_retri":r,"fg_base":B,
+ *    "fg":[[5 停點, S, 贏分], ...],"total":總贏分（線注單位）,"win":總贏分 × bet/line}
+ * 量兩段延遲：spin() 本身，與請求讀入到回應寫出（含格式化與 flush）；以 WinHist（µs）累計，
+ * stdin 讀到 EOF、或每條連線結束時於 stderr 輸出 p50 / p99 / p99.9 / max
  **************/
-static atomic<long long> spinsDone{0};
+static bool serveMode = false;
+static string serveSocketPath;                   // 空 = stdin/stdout
+static const uint64_t SERVE_STREAM = 7ULL << 60; // 帶 K 的請求用 +2K，第 c 條連線用 +2c+1
 
-static string everyStr(long long totalSpins, long long count)
+struct ServeStats
 {
-    if (count <= 0)
-        return "（—）";
-    ostringstream oss;
-    oss << "（約每 " << llround((double)totalSpins / (double)count) << " 轉一次）";
-    return oss.str();
+    long long requests = 0, errors = 0;
+    long long won = 0;              // 總贏分（線注單位）
+    double spinMax = 0, reqMax = 0; // µs
+    WinHist spinLat, reqLat;        // µs
+
+    void merge(const ServeStats &o)
+    {
+        requests += o.requests;
+        errors += o.errors;
+        won += o.won;
+        spinMax = max(spinMax, o.spinMax);
+        reqMax = max(reqMax, o.reqMax);
+        spinLat.merge(o.spinLat);
+        reqLat.merge(o.reqLat);
+    }
+};
+
+static void appendInt(string &s, long long v)
+{
+    char b[24];
+    s.append(b, (size_t)std::snprintf(b, sizeof(b), "%lld", v));
 }
 
-// 啟動心跳：回傳一個 lambda（呼叫即停止心跳）
-static function<void()> startProgress(long long total)
-{
-    auto start = chrono::steady_clock::now();
-    auto *stopFlag = new atomic<bool>(false);
-    // [Lambda #1]：背景心跳執行緒要跑的函式（放進 std::thread 裡）（以 [=] 值捕捉 start/stopFlag/total）
-    thread t([=]()
-             {
-        while (!stopFlag->load(memory_order_relaxed)) {
-            this_thread::sleep_for(chrono::seconds(1)); // 每秒回報
-            long long done = spinsDone.load();
-            double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
-            double speed = done / max(1e-9, elapsed);
-            double eta = (total - done) / max(1e-9, speed);
-            std::fprintf(stderr, "[PROGRESS] %lld/%lld (%.2f%%) | %.0f spins/s | ETA %.0fs\n",
-                (long long)done, (long long)total,
-                100.0 * double(done) / double(total),
-                speed, eta);
-        } });
-    t.detach();
-    // [Lambda #2]：回傳給呼叫端的「停止心跳」函式
-    return [stopFlag]()
+// 一條請求流（stdin 或一條連線）跑到 EOF；回應緩衝與 SpinRecord 每條流配置一次
+template <class Rng>
+static void serveStream(const SlotEngine &E, FILE *in, FILE *out, uint64_t conn, ServeStats &st)
+{
+    using clk = chrono::steady_clock;
+    Rng own = makeStream<Rng>(runSeed, SERVE_STREAM + 2 * conn + 1);
+    unique_ptr<SpinRecord> rec(new SpinRecord);
+    string resp;
+    resp.reserve(1 << 16);
+    char line[256];
+
+    while (std::fgets(line, sizeof(line), in))
     {
-        stopFlag->store(true); // 通知 #1 的 while 退出
-        delete stopFlag;
-    };
+        const clk::time_point t0 = clk::now();
+        if (!strchr(line, '\n'))
+            for (int ch; (ch = std::fgetc(in)) != EOF && ch != '\n';) // 過長的行：丟棄剩餘部分
+                ;
+
+        const char *p = line;
+        while (*p == ' ' || *p == '\t')
+            p++;
+        // K 只接受十進位數字開頭（strtoull 會把 "-1" 繞成 2^64-1）且須 < 2^59，使 SERVE_STREAM + 2K 不溢位
+        char *end = nullptr;
+        errno = 0;
+        const unsigned long long key = isdigit((unsigned char)*p) ? strtoull(p, &end, 10) : 0;
+        const bool keyed = end && errno == 0 && key < (1ULL << 59) && (*end == '\0' || isspace((unsigned char)*end));
+        const bool plain = *p == '\0' || *p == '\n' || *p == '\r' || strncmp(p, "spin", 4) == 0;
+
+        resp.clear();
+        if (!keyed && !plain)
+        {
+            st.errors++;
+            resp += "{\"error\":\"bad request\"}\n";
+            std::fwrite(resp.data(), 1, resp.size(), out);
+            std::fflush(out);
+            continue;
+        }
+
+        double spinUs;
+        if (keyed)
+        {
+            Rng r = makeStream<Rng>(runSeed, SERVE_STREAM + 2 * (uint64_t)key);
+            const clk::time_point s0 = clk::now();
+            E.spin(r, *rec);
+            spinUs = chrono::duration<double, micro>(clk::now() - s0).count();
+        }
+        else
+        {
+            const clk::time_point s0 = clk::now();
+            E.spin(own, *rec);
+            spinUs = chrono::duration<double, micro>(clk::now() - s0).count();
+        }
+
+        const SpinRecord &r = *rec;
+        resp += "{\"key\":";
+        if (keyed)
+            appendInt(resp, (long long)key);
+        else
+            resp += "null";
+        resp += ",\"stops\":[";
+        for (int k = 0; k < 5; k++)
+        {
+            if (k)
+                resp += ',';
+            appendInt(resp, r.stops[k]);
+        }
+        resp += "],\"scatter\":";
+        appendInt(resp, r.scatter);
+        resp += ",\"mg\":";
+        appendInt(resp, r.mgWin);
+        resp += ",\"mul\":";
+        appendInt(resp, r.fgMul);
+        resp += ",\"fg_spins\":";
+        appendInt(resp, r.fgSpins);
+        resp += ",\"fg_retri\":";
+        appendInt(resp, r.fgRetri);
+        resp += ",\"fg_base\":";
+        appendInt(resp, r.fgBase);
+        resp += ",\"fg\":[";
+        for (int i = 0; i < min(r.fgSpins, SpinRecord::MAX_FG); i++)
+        {
+            const FgSpinRecord &f = r.fg[i];
+            resp += i ? ",[" : "[";
+            for (int k = 0; k < 5; k++)
+            {
+                appendInt(resp, f.stops[k]);
+                resp += ',';
+            }
+            appendInt(resp, f.scatter);
+            resp += ',';
+            appendInt(resp, f.win);
+            resp += ']';
+        }
+        resp += "],\"total\":";
+        appendInt(resp, r.totalWin);
+        char b[48];
+        resp.append(b, (size_t)std::snprintf(b, sizeof(b), ",\"win\":%.4f}\n", (double)r.totalWin * betPerLine));
+        std::fwrite(resp.data(), 1, resp.size(), out);
+        std::fflush(out);
+
+        const double reqUs = chrono::duration<double, micro>(clk::now() - t0).count();
+        st.requests++;
+        st.won += r.totalWin;
+        st.spinLat.add(spinUs);
+        st.reqLat.add(reqUs);
+        st.spinMax = max(st.spinMax, spinUs);
+        st.reqMax = max(st.reqMax, reqUs);
+    }
+}
+
+static void printServe(const ServeStats &t, const char *scope)
+{
+    std::fprintf(stderr, "[SERVE] %s | %lld 請求（錯誤 %lld）| 平均贏分 %.4f×bet | seed=%llu | rng=%s | kernel=%s\n",
+                 scope, t.requests, t.errors, (double)t.won / (double)max(1LL, t.requests) / numLines,
+                 (unsigned long long)runSeed, rngName(rngKind), kernelName(lineKernel));
+    if (t.requests == 0)
+        return;
+    std::fprintf(stderr, "[SERVE] spin() µs          p50 %.3f | p99 %.3f | p99.9 %.3f | max %.3f\n",
+                 t.spinLat.quantile(0.5), t.spinLat.quantile(0.99), t.spinLat.quantile(0.999), t.spinMax);
+    std::fprintf(stderr, "[SERVE] 請求 µs（讀入→寫出）p50 %.3f | p99 %.3f | p99.9 %.3f | max %.3f\n",
+                 t.reqLat.quantile(0.5), t.reqLat.quantile(0.99), t.reqLat.quantile(0.999), t.reqMax);
+}
+
+#if !defined(_WIN32)
+static volatile sig_atomic_t serveWakeFd = -1; // --serve-socket 的 self-pipe 寫端
+
+static void onServeSignal(int)
+{
+    const char b = 1;
+    const int saved = errno;
+    if (serveWakeFd >= 0)
+    {
+        const ssize_t r = write(serveWakeFd, &b, 1); // 已有待處理的位元組時失敗亦無妨
+        (void)r;
+    }
+    errno = saved;
+}
+#endif
+
+template <class Rng>
+static int runServe(const Game &g)
+{
+    const SlotEngine E(g, lineKernel); // 命令列已解析的核心
+    if (serveSocketPath.empty())
+    {
+        ServeStats st;
+        serveStream<Rng>(E, stdin, stdout, 0, st);
+        printServe(st, "stdin");
+        return 0;
+    }
+#if defined(_WIN32)
+    std::fprintf(stderr, "[SERVE] --serve-socket 僅支援 POSIX（Unix socket）；Windows 請用 --serve 搭配 stdin\n");
+    return 1;
+#else
+    signal(SIGPIPE, SIG_IGN); // 客戶端先斷線時 write 回錯誤而非結束行程
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (serveSocketPath.size() >= sizeof(addr.sun_path))
+    {
+        std::fprintf(stderr, "[SERVE] socket 路徑過長：%s\n", serveSocketPath.c_str());
+        return 1;
+    }
+    memcpy(addr.sun_path, serveSocketPath.c_str(), serveSocketPath.size() + 1);
+    unlink(serveSocketPath.c_str());
+    const int srv = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (srv < 0 || bind(srv, (const sockaddr *)&addr, sizeof(addr)) < 0 || listen(srv, 64) < 0)
+    {
+        std::fprintf(stderr, "[SERVE] 無法監聽 %s：%s\n", serveSocketPath.c_str(), strerror(errno));
+        if (srv >= 0)
+            close(srv);
+        return 1;
+    }
+    std::fprintf(stderr, "[SERVE] 監聽 %s | seed=%llu\n", serveSocketPath.c_str(), (unsigned long long)runSeed);
+
+    // SIGINT/SIGTERM：處理函式只往 self-pipe 寫一個位元組（不論落在哪條執行緒），accept 迴圈以 poll 同時等待兩者
+    int wake[2];
+    if (pipe(wake) < 0)
+    {
+        std::fprintf(stderr, "[SERVE] pipe 失敗：%s\n", strerror(errno));
+        close(srv);
+        return 1;
+    }
+    serveWakeFd = wake[1];
+    struct sigaction sa{}, oldInt{}, oldTerm{};
+    sa.sa_handler = onServeSignal;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART; // 連線執行緒的 read 不因訊號中斷
+    sigaction(SIGINT, &sa, &oldInt);
+    sigaction(SIGTERM, &sa, &oldTerm);
+
+    // 連線執行緒 detach；live 記錄仍開著的連線 fd（關閉前自行移除），running 為尚未結束的執行緒數
+    mutex m;
+    condition_variable idle;
+    ServeStats total;
+    map<uint64_t, int> live;
+    int running = 0;
+    for (uint64_t c = 1;; c++)
+    {
+        pollfd pf[2] = {{srv, POLLIN, 0}, {wake[0], POLLIN, 0}};
+        if (poll(pf, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            std::fprintf(stderr, "[SERVE] poll 失敗：%s\n", strerror(errno));
+            break;
+        }
+        if (pf[1].revents)
+        {
+            std::fprintf(stderr, "[SERVE] 收到結束訊號，停止接受連線\n");
+            break;
+        }
+        const int fd = accept(srv, nullptr, nullptr);
+        if (fd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            std::fprintf(stderr, "[SERVE] accept 失敗：%s\n", strerror(errno));
+            break;
+        }
+        {
+            lock_guard<mutex> lk(m);
+            live[c] = fd;
+            running++;
+        }
+        thread([&, fd, c]()
+               {
+            FILE *in = fdopen(fd, "r");
+            FILE *out = fdopen(dup(fd), "w");
+            ServeStats st;
+            if (in && out)
+                serveStream<Rng>(E, in, out, c, st);
+            {
+                lock_guard<mutex> lk(m);
+                live.erase(c);
+            }
+            if (in)
+                std::fclose(in);
+            else
+                close(fd);
+            if (out)
+                std::fclose(out);
+            lock_guard<mutex> lk(m);
+            total.merge(st);
+            printServe(total, "累計");
+            running--;
+            idle.notify_all(); })
+            .detach();
+    }
+
+    // 收尾：還原訊號處理（再按一次 Ctrl-C 即直接結束）、關閉監聽、讓既有連線讀到 EOF，等全部執行緒結束
+    sigaction(SIGINT, &oldInt, nullptr);
+    sigaction(SIGTERM, &oldTerm, nullptr);
+    close(srv);
+    unlink(serveSocketPath.c_str());
+    {
+        unique_lock<mutex> lk(m);
+        for (const auto &kv : live)
+            shutdown(kv.second, SHUT_RDWR);
+        idle.wait(lk, [&]
+                  { return running == 0; });
+    }
+    serveWakeFd = -1;
+    close(wake[0]);
+    close(wake[1]);
+    printServe(total, "socket");
+    return 0;
+#endif
 }
 
 /**************
- * Worker：負責跑自己份內的轉數（本地統計 → 結束時寫回）
+ * MG/FG 管線模式（--pipeline；--mg-threads A --fg-threads B 分別指定兩池大小）
+ * MG 執行緒向共用計數器領塊，以該塊的 MG 子流跑主遊戲，觸發時記下 (MG 線獎, S 數)；
+ * 整塊跑完後把塊號推進無鎖 MPMC 佇列。FG 執行緒取出塊號，以該塊的 FG 子流依觸發順序跑 playFG，
+ * 並在此補上各觸發把的分層/RTP 統計。亂數流與各塊 Stats 只由塊號決定，結果與 --mg-threads / --fg-threads 無關
  **************/
-static void worker(int /*id*/, long long spins, Stats *out, uint64_t seed)
-{
-    mt19937_64 rng(seed);
-    Window5x3 w{};
-    Stats local{};
-    const double perSpinBet = (double)numLines * betPerLine;
+static bool pipelineMode = false;
+static int mgThreads = 0, fgThreads = 0; // 0 = 依 numWorkers 自動分配
 
-    const long long bump = 4096; // 降低 atomic 次數
-    long long bumpCnt = 0;
+// 有界 MPMC 佇列（Vyukov）：每格以序號判斷可寫/可讀，push/pop 各一次 CAS
+template <class T>
+class MpmcQueue
+{
+    struct Cell
+    {
+        atomic<size_t> seq;
+        T data;
+    };
+    unique_ptr<Cell[]> buf;
+    size_t mask;
+    alignas(64) atomic<size_t> enq{0};
+    alignas(64) atomic<size_t> deq{0};
 
-    for (long long i = 0; i < spins; i++)
+public:
+    explicit MpmcQueue(size_t capPow2) : buf(new Cell[capPow2]), mask(capPow2 - 1)
     {
-        //  主遊戲轉窗 + 線獎（未觸發 FG 時也可能有線獎）
-        spinWindow(rng, reelsMG, &w);
-        double mgLine = evalAllLines(&w, &payMG) * betPerLine;
-        double spinTotal = mgLine;
-
-        //  觸發 FG？（3+S）
-        int s = countScatter(&w);
-        if (s >= 3)
-        {
-            local.triggerCount++;
-            double mul = fgMulByScatter(s);
-            if (s >= 5)
-                local.trigX100++;
-            else if (s == 4)
-                local.trigX50++;
+        for (size_t i = 0; i < capPow2; i++)
+            buf[i].seq.store(i, memory_order_relaxed);
+    }
+    bool push(const T &v)
+    {
+        size_t pos = enq.load(memory_order_relaxed);
+        for (;;)
+        {
+            Cell &c = buf[pos & mask];
+            intptr_t dif = (intptr_t)c.seq.load(memory_order_acquire) - (intptr_t)pos;
+            if (dif == 0)
+            {
+                if (enq.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+                {
+                    c.data = v;
+                    c.seq.store(pos + 1, memory_order_release);
+                    return true;
+                }
+            }
+            else if (dif < 0)
+                return false; // 滿
             else
-                local.trigX10++;
-
-            //  跑完整串 FG（換 FG 輪帶/賠率），回來加總
-            auto [fgSp, fgBase, retri, zeroB, totalB] = playFG(rng, &w);
-            local.totalFGSpins += fgSp;
-            local.retriggerCount += retri;
-            local.fgZeroBatches += zeroB;
-            local.fgTotalBatches += totalB;
-
-            double fgWin = fgBase * mul;
-            local.freeGameWinSum += fgWin;
-            spinTotal += fgWin;
-        }
-        else if (mgLine == 0.0)
-        {
-            local.deadSpins++; // MG 無線獎且沒進 FG
-        }
-
-        //  峰值 & 分層
-        local.mainLineWinSum += mgLine;
-        if (spinTotal > local.maxSingleSpin)
-            local.maxSingleSpin = spinTotal;
-
-        double ratio = spinTotal / perSpinBet; // 單把贏分/押注 倍率
-        if (ratio >= 1000)
-            local.jojoWins++;
-        else if (ratio >= 500)
-            local.jumboWins++;
-        else if (ratio >= 300)
-            local.holyWins++;
-        else if (ratio >= 100)
-            local.superWins++;
-        else if (ratio >= 60)
-            local.megaWins++;
-        else if (ratio >= 20)
-            local.bigWins++;
-
-        // x1000 以上再分層
-        if (ratio >= HIGH_BIN_EDGES[0])
-        {
-            // 從最大門檻往回找，找到第一個符合 ratio >= edge 的 bin
-            for (int bi = NUM_HIGH_BINS - 1; bi >= 0; --bi)
-            {
-                if (ratio >= HIGH_BIN_EDGES[bi])
+                pos = enq.load(memory_order_relaxed);
+        }
+    }
+    bool pop(T &v)
+    {
+        size_t pos = deq.load(memory_order_relaxed);
+        for (;;)
+        {
+            Cell &c = buf[pos & mask];
+            intptr_t dif = (intptr_t)c.seq.load(memory_order_acquire) - (intptr_t)(pos + 1);
+            if (dif == 0)
+            {
+                if (deq.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
                 {
-                    local.hiWinBins[bi]++;
-                    break;
+                    v = c.data;
+                    c.seq.store(pos + mask + 1, memory_order_release);
+                    return true;
+                }
+            }
+            else if (dif < 0)
+                return false; // 空
+            else
+                pos = deq.load(memory_order_relaxed);
+        }
+    }
+    size_t sizeApprox() const
+    {
+        size_t e = enq.load(memory_order_relaxed), d = deq.load(memory_order_relaxed);
+        return e > d ? e - d : 0;
+    }
+};
+
+struct TriggerRecord
+{
+    long long mgLine; // 觸發那把的 MG 線獎（線注單位）
+    int scatter;   // 觸發時的 S 數（決定倍率）
+};
+
+// 一塊在 MG 與 FG 之間交接的內容：MG 部分的 Tally 與依序的觸發紀錄
+struct PipelineChunk
+{
+    Tally t{};
+    vector<TriggerRecord> trig;
+};
+
+struct StageTiming
+{
+    double busySec = 0; // 有工作的時間
+    double waitSec = 0; // MG：佇列滿等待；FG：佇列空等待
+    long long items = 0;
+};
+
+// 回傳依塊號順序合併的總計（與 runScheduled 相同，經 ChunkLedger 併入）
+template <class Rng>
+static Tally runPipeline(const Game &g, uint64_t seed)
+{
+    const int A = mgThreads, B = fgThreads;
+    const auto [first, last] = chunkRange();
+    // 佇列放塊號、每塊交接內容另存；容量約為 FG 執行緒數的 4 倍，MG 領先太多即等待（限制暫存記憶體）
+    size_t cap = 4;
+    while (cap < 4 * (size_t)B)
+        cap <<= 1;
+    MpmcQueue<long long> queue(cap);
+    vector<unique_ptr<PipelineChunk>> slots((size_t)(last - first));
+    ChunkLedger ledger(first, last);
+    atomic<long long> nextChunk{first};
+    atomic<int> mgRunning{A};
+    vector<StageTiming> mgT(A), fgT(B);
+    long long fgSpinsTotal = 0;
+    vector<long long> fgSpins(B, 0);
+
+    auto mgLoop = [&](int id)
+    {
+        Window5x3 w{};
+        double waitSec = 0;
+        long long spins = 0, bumpCnt = 0;
+        auto t0 = chrono::steady_clock::now();
+        for (long long c; (c = nextChunk.fetch_add(1, memory_order_relaxed)) < last;)
+        {
+            Rng rng = makeStream<Rng>(seed, chunkStreamMG(c)); // 與排程模式同一條 MG 子流
+            unique_ptr<PipelineChunk> pc(new PipelineChunk);
+            Stats &local = pc->t.st;
+            WinDist &dist = pc->t.dist;
+            const long long n = min(chunkSpins, numSpins - c * chunkSpins);
+            for (long long i = 0; i < n; i++)
+            {
+                SpinOutcome o = spinEval<MG>(g, rng, &w);
+                const long long mgLine = o.line;
+                local.mainLineWinSum += mgLine;
+                if (o.scatter >= 3)
+                {
+                    recordTrigger(g.def, local, o.scatter);
+                    pc->trig.push_back({mgLine, o.scatter});
+                }
+                else
+                {
+                    if (mgLine == 0)
+                        local.deadSpins++;
+                    recordSpinTotal(g.def, local, dist, mgLine, mgLine);
+                }
+                if (++bumpCnt == 4096)
+                {
+                    spinsDone.fetch_add(bumpCnt, memory_order_relaxed);
+                    bumpCnt = 0;
+                }
+            }
+            spins += n;
+            slots[(size_t)(c - first)] = move(pc);
+            if (!queue.push(c))
+            {
+                auto ws = chrono::steady_clock::now();
+                while (!queue.push(c))
+                    this_thread::yield();
+                waitSec += chrono::duration<double>(chrono::steady_clock::now() - ws).count();
+            }
+        }
+        spinsDone.fetch_add(bumpCnt, memory_order_relaxed);
+        double total = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        mgT[id] = {total - waitSec, waitSec, spins};
+        mgRunning.fetch_sub(1, memory_order_release);
+    };
+
+    auto fgLoop = [&](int id)
+    {
+        Window5x3 w{};
+        double waitSec = 0;
+        long long sessions = 0;
+        auto t0 = chrono::steady_clock::now();
+        long long c = 0;
+        for (;;)
+        {
+            if (!queue.pop(c))
+            {
+                // 先讀 MG 是否全數結束再重試一次，避免漏掉最後推入的塊
+                bool mgDone = mgRunning.load(memory_order_acquire) == 0;
+                if (!queue.pop(c))
+                {
+                    if (mgDone)
+                        break;
+                    auto ws = chrono::steady_clock::now();
+                    this_thread::yield();
+                    waitSec += chrono::duration<double>(chrono::steady_clock::now() - ws).count();
+                    continue;
                 }
             }
+            unique_ptr<PipelineChunk> pc = move(slots[(size_t)(c - first)]);
+            Stats &local = pc->t.st;
+            WinDist &dist = pc->t.dist;
+            Rng rng = makeStream<Rng>(seed, chunkStreamFG(c)); // 每塊一條 FG 子流，依觸發順序消耗
+            for (const TriggerRecord &rec : pc->trig)
+            {
+                const long long fgWin = recordFG(local, dist, drawFG(g, rng, &w), fgMulByScatter(g.def, rec.scatter));
+                recordSpinTotal(g.def, local, dist, rec.mgLine, rec.mgLine + fgWin); // 與 MG 線獎合併後再分層
+            }
+            sessions += (long long)pc->trig.size();
+            fgSpins[id] += local.totalFGSpins;
+            ledger.complete((size_t)(c - first), pc->t);
         }
+        double total = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        fgT[id] = {total - waitSec, waitSec, sessions};
+    };
+
+    // 佇列深度取樣（主執行緒，每 10ms）
+    vector<thread> threads;
+    for (int i = 0; i < A; i++)
+        threads.emplace_back(mgLoop, i);
+    for (int i = 0; i < B; i++)
+        threads.emplace_back(fgLoop, i);
+
+    auto t0 = chrono::steady_clock::now();
+    size_t maxDepth = 0;
+    double depthSum = 0;
+    long long samples = 0;
+    while (mgRunning.load(memory_order_acquire) > 0 || queue.sizeApprox() > 0)
+    {
+        this_thread::sleep_for(chrono::milliseconds(10));
+        size_t d = queue.sizeApprox();
+        maxDepth = max(maxDepth, d);
+        depthSum += (double)d;
+        samples++;
+    }
+    for (auto &th : threads)
+        th.join();
+    double wall = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    long long mgSpins = 0, sessions = 0;
+    double mgBusy = 0, mgWait = 0, fgBusy = 0, fgWait = 0;
+    for (int i = 0; i < A; i++)
+    {
+        mgSpins += mgT[i].items;
+        mgBusy += mgT[i].busySec;
+        mgWait += mgT[i].waitSec;
+    }
+    for (int i = 0; i < B; i++)
+    {
+        sessions += fgT[i].items;
+        fgBusy += fgT[i].busySec;
+        fgWait += fgT[i].waitSec;
+        fgSpinsTotal += fgSpins[i];
+    }
+    std::fprintf(stderr, "[PIPELINE] 佇列深度（塊）：平均 %.1f | 最大 %zu（容量 %zu）\n",
+                 samples ? depthSum / (double)samples : 0.0, maxDepth, cap);
+    std::fprintf(stderr, "[PIPELINE] MG %d 執行緒 | %.0f spins/s（每執行緒忙碌時 %.0f）| 佇列滿等待 %.2fs\n",
+                 A, (double)mgSpins / max(1e-9, wall), (double)mgSpins / max(1e-9, mgBusy), mgWait);
+    std::fprintf(stderr, "[PIPELINE] FG %d 執行緒 | %.0f 串/s、%.0f FG spins/s（每執行緒忙碌時 %.0f 串/s）| 佇列空等待 %.2fs\n",
+                 B, (double)sessions / max(1e-9, wall), (double)fgSpinsTotal / max(1e-9, wall),
+                 (double)sessions / max(1e-9, fgBusy), fgWait);
 
-        //  per-spin RTP 統計
-        local.rtpSum += ratio;
-        local.rtpSumSq += ratio * ratio;
-        local.nSpins++;
+    return ledger.prefixTally();
+}
 
-        //  進度累加（每 4096 轉一次）
-        if (++bumpCnt == bump)
-        {
-            spinsDone.fetch_add(bump, memory_order_relaxed);
-            bumpCnt = 0;
-        }
+/**************
+ * 亂數產生器吞吐量（--rng-bench）：單執行緒，各產生器的原始輸出、無偏停點與完整 MG 轉
+ **************/
+static void runRngBench()
+{
+    const long long draws = 50000000, spins = 5000000;
+    cout << "=== RNG 吞吐量（單執行緒 | engine="
+         << (evalEngine == EvalEngine::Column ? "column" : kernelName(lineKernel)) << "）===\n";
+    cout << left << setw(16) << "generator" << right << setw(14) << "ns/uint64" << setw(14) << "ns/停點"
+         << setw(16) << "MG spins/s" << "\n";
+    for (RngKind k : {RngKind::MT, RngKind::Xoshiro, RngKind::SplitMix, RngKind::Philox})
+    {
+        withRng(k, [&](auto tag)
+                {
+            using R = typename decltype(tag)::type;
+            R rng(0x243F6A8885A308D3ULL);
+            uint64_t sink = 0;
+            auto t0 = chrono::steady_clock::now();
+            for (long long i = 0; i < draws; i++)
+                sink += rng();
+            auto t1 = chrono::steady_clock::now();
+            for (long long i = 0; i < draws; i++)
+                sink += boundedRand(rng, 57);
+            auto t2 = chrono::steady_clock::now();
+            Window5x3 w{};
+            for (long long i = 0; i < spins; i++)
+                sink += (uint64_t)spinEval<MG>(*games[0], rng, &w).scatter;
+            auto t3 = chrono::steady_clock::now();
+            auto sec = [](auto a, auto b) { return chrono::duration<double>(b - a).count(); };
+            cout << left << setw(16) << R::name << right << fixed << setprecision(2)
+                 << setw(14) << sec(t0, t1) * 1e9 / (double)draws
+                 << setw(14) << sec(t1, t2) * 1e9 / (double)draws
+                 << setw(16) << setprecision(0) << (double)spins / sec(t2, t3)
+                 << "   (checksum " << (sink & 0xFFFF) << ")\n"; });
     }
-    if (bumpCnt > 0)
-        spinsDone.fetch_add(bumpCnt, memory_order_relaxed);
-
-    *out = local; // 將本地統計回寫
 }
 
 /**************
- * 主程式：初始化 → 併發跑轉 → 彙總輸出
+ * 基準測試（--bench FILE）：單執行緒微基準 + 1..N 執行緒強擴展，結果寫成 JSON
+ *   微基準：spinWindow / linePay / evalAllLines / evalLines（目前核心）/ countScatter / playFG / 完整 MG 轉，
+ *           各取 5 輪中最快一輪的 ns/op；x86 另以 TSC 計 tsc/op（參考時脈，非核心時脈）
+ *   擴展：固定 --bench-spins 總轉數，依序以 1、2、4…、N（= --threads）個 worker 跑排程模式，
+ *         輸出牆鐘、spins/s、加速比與效率，並檢查各執行緒數的 RTP 逐位元相同
+ * 同一 JSON 可跨版本/跨 --rng、--engine、--kernel、--sched 比對，抓吞吐量退步
  **************/
-int main()
+static string benchPath;                  // 空 = 不跑
+static long long benchSpins = 1LL << 24; // 擴展測試總轉數
+
+struct BenchResult
 {
-#ifdef _WIN32
-    // 主控台改用 UTF-8，避免 中文/符號 亂碼（與 /utf-8 編譯搭配）
-    SetConsoleOutputCP(65001);
-    SetConsoleCP(65001);
-#endif
+    string name;
+    double nsPerOp, tscPerOp;
+};
 
-    ios::sync_with_stdio(false);
-    cin.tie(nullptr);
+// 跑 fn(reps) 5 輪取最快；reps 依第一輪自動放大到每輪約 50ms
+template <class F>
+static BenchResult benchOne(const string &name, long long opsPerRep, F fn)
+{
+    long long reps = 1;
+    for (;;)
+    {
+        auto t0 = chrono::steady_clock::now();
+        fn(reps);
+        double sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        if (sec >= 0.05 || reps >= (1LL << 40))
+            break;
+        reps *= sec > 0.005 ? max(2LL, (long long)(0.05 / sec)) : 10;
+    }
+    double bestNs = 1e300, bestTsc = 1e300;
+    for (int round = 0; round < 5; round++)
+    {
+        uint64_t c0 = readTsc();
+        auto t0 = chrono::steady_clock::now();
+        fn(reps);
+        double sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        uint64_t c1 = readTsc();
+        const double ops = (double)reps * (double)opsPerRep;
+        bestNs = min(bestNs, sec * 1e9 / ops);
+        bestTsc = min(bestTsc, (double)(c1 - c0) / ops);
+    }
+    return {name, bestNs, readTsc() ? bestTsc : 0.0};
+}
 
-    // 啟動：載入輪帶（字串轉成符號碼）
-    reelsMG = packReels(reelsMGstr);
-    reelsFG = packReels(reelsFGstr);
+template <class Rng>
+static vector<BenchResult> runMicroBench(const Game &g)
+{
+    vector<BenchResult> out;
+    Rng rng = makeStream<Rng>(runSeed, 0);
+    Window5x3 w{};
+    volatile uint64_t sinkV = 0;
+    uint64_t sink = 0;
 
-    // 進度心跳（每秒報告）
-    if (numWorkers <= 0)
-        numWorkers = 1;
-    auto stopHb = startProgress(numSpins);
+    // 固定一批視窗供線獎/數 S 使用（避免把抽停點算進去）
+    const int POOL = 4096;
+    vector<Window5x3> pool(POOL);
+    for (auto &pw : pool)
+        spinWindow<MG>(g.def, rng, &pw);
 
-    const double totalBet = (double)numSpins * (double)numLines * betPerLine;
-    const double perSpinBet = (double)numLines * betPerLine;
+    out.push_back(benchOne("spinWindow<MG>", 1, [&](long long reps)
+                           {
+        for (long long i = 0; i < reps; i++)
+        {
+            spinWindow<MG>(g.def, rng, &w);
+            sink += w.c[2][1];
+        } }));
+    out.push_back(benchOne("linePay", (long long)POOL * numLines, [&](long long reps)
+                           {
+        long long s = 0;
+        for (long long r = 0; r < reps; r++)
+            for (const auto &pw : pool)
+                for (const auto &line : g.def.lines)
+                    s += linePay(g.def.pay[MG], &pw, line);
+        sink += (uint64_t)s; }));
+    out.push_back(benchOne("evalAllLines<MG>", POOL, [&](long long reps)
+                           {
+        long long s = 0;
+        for (long long r = 0; r < reps; r++)
+            for (const auto &pw : pool)
+                s += evalAllLines<MG>(g.def, &pw);
+        sink += (uint64_t)s; }));
+    out.push_back(benchOne(string("evalLines<MG>[") + kernelName(lineKernel) + "]", POOL, [&](long long reps)
+                           {
+        long long s = 0;
+        for (long long r = 0; r < reps; r++)
+            for (const auto &pw : pool)
+                s += evalLines<MG>(g.def, g.bb[MG], &pw);
+        sink += (uint64_t)s; }));
+    out.push_back(benchOne("countScatter", POOL, [&](long long reps)
+                           {
+        for (long long r = 0; r < reps; r++)
+            for (const auto &pw : pool)
+                sink += (uint64_t)countScatter(&pw); }));
+    out.push_back(benchOne("playFG", 1, [&](long long reps)
+                           {
+        for (long long i = 0; i < reps; i++)
+            sink += (uint64_t)get<0>(playFG(g, rng, &w)); }));
+    out.push_back(benchOne(string("MG spin[") + (evalEngine == EvalEngine::Column ? "column" : "window") + "]", 1,
+                           [&](long long reps)
+                           {
+        Stats local{};
+        WinDist dist;
+        Rng rngFG = makeStream<Rng>(runSeed, 1);
+        runSpins(g, rng, rngFG, &w, nullptr, reps, local, dist);
+        sink += (uint64_t)local.nSpins; }));
+    sinkV = sink;
+    (void)sinkV;
+    return out;
+}
 
-    // 依 worker 平分轉數（前 rem 個多 1 轉）
-    vector<thread> threads;
-    vector<Stats> stats(numWorkers);
-    long long chunk = numSpins / numWorkers;
-    long long rem = numSpins % numWorkers;
+struct ScalePoint
+{
+    int threads;
+    double wall, spinsPerSec, rtp;
+};
 
-    uint64_t baseSeed = (uint64_t)chrono::high_resolution_clock::now().time_since_epoch().count();
+template <class Rng>
+static vector<ScalePoint> runScalingBench(int maxThreads)
+{
+    vector<int> counts;
+    for (int t = 1; t < maxThreads; t *= 2)
+        counts.push_back(t);
+    counts.push_back(maxThreads);
 
-    for (int i = 0; i < numWorkers; i++)
+    const long long savedSpins = numSpins, savedFirst = chunkFirst, savedLast = chunkLast;
+    const int savedWorkers = numWorkers;
+    numSpins = benchSpins;
+    chunkFirst = 0;
+    chunkLast = -1;
+    vector<ScalePoint> out;
+    for (int t : counts)
     {
-        long long spins = chunk + ((long long)i < rem ? 1 : 0);
-        threads.emplace_back([i, spins, &stats, baseSeed]()
-                             { worker(i, spins, &stats[i], baseSeed + (uint64_t)i * 1337ULL); });
+        numWorkers = t;
+        auto t0 = chrono::steady_clock::now();
+        const Stats total = runScheduled<Rng>()[0].st;
+        double wall = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        out.push_back({t, wall, (double)total.nSpins / wall, spinRtpMean(total)});
     }
-    for (auto &th : threads)
-        th.join();
+    numSpins = savedSpins;
+    chunkFirst = savedFirst;
+    chunkLast = savedLast;
+    numWorkers = savedWorkers;
+    return out;
+}
+
+static string jsonStr(const string &s)
+{
+    string o = "\"";
+    for (char c : s)
+        o += (c == '"' || c == '\\') ? string("\\") + c : string(1, c);
+    return o + "\"";
+}
+
+static void runBench()
+{
+    const Game &g = *games[0];
+    vector<BenchResult> micro;
+    vector<ScalePoint> scale;
+    withRng(rngKind, [&](auto tag)
+            {
+        using R = typename decltype(tag)::type;
+        micro = runMicroBench<R>(g);
+        scale = runScalingBench<R>(numWorkers); });
 
-    // 停心跳
-    stopHb();
+    bool deterministic = true;
+    for (const ScalePoint &p : scale)
+        deterministic = deterministic && p.rtp == scale[0].rtp;
 
-    // 匯總所有 worker 的統計
-    Stats total{};
-    for (int i = 0; i < numWorkers; i++)
+    cout << "=== Bench | " << g.def.name << " | rng=" << rngName(rngKind) << " | engine="
+         << (evalEngine == EvalEngine::Column ? "column" : "window") << " | kernel=" << kernelName(lineKernel)
+         << " | batch=" << batchSize << " ===\n";
+    cout << fixed;
+    for (const BenchResult &r : micro)
+    {
+        cout << left << setw(28) << r.name << right << setprecision(2) << setw(12) << r.nsPerOp << " ns/op";
+        if (r.tscPerOp > 0)
+            cout << setw(12) << setprecision(1) << r.tscPerOp << " tsc/op";
+        cout << "\n";
+    }
+    cout << "\n強擴展（" << benchSpins << " 轉，sched=" << (schedMode == Sched::Steal ? "steal" : "static")
+         << "，chunk=" << chunkSpins << "）\n";
+    for (const ScalePoint &p : scale)
     {
-        const auto &s = stats[i];
-        total.mainLineWinSum += s.mainLineWinSum;
-        total.freeGameWinSum += s.freeGameWinSum;
-        total.triggerCount += s.triggerCount;
-        total.retriggerCount += s.retriggerCount;
-        total.totalFGSpins += s.totalFGSpins;
-        total.maxSingleSpin = max(total.maxSingleSpin, s.maxSingleSpin);
-        total.deadSpins += s.deadSpins;
+        double speedup = scale[0].wall / p.wall;
+        cout << "threads " << setw(3) << p.threads << " | 牆鐘 " << setprecision(3) << p.wall << "s | "
+             << setprecision(0) << p.spinsPerSec << " spins/s | 加速 " << setprecision(2) << speedup << "× | 效率 "
+             << setprecision(1) << 100.0 * speedup / p.threads << "%\n";
+    }
+    cout << "各執行緒數 RTP " << (deterministic ? "逐位元相同" : "不一致（決定性退步！）") << "\n";
 
-        total.trigX10 += s.trigX10;
-        total.trigX50 += s.trigX50;
-        total.trigX100 += s.trigX100;
+    ostringstream js;
+    js << setprecision(10);
+    js << "{\n  \"game\": " << jsonStr(g.def.name) << ",\n  \"rng\": " << jsonStr(rngName(rngKind))
+       << ",\n  \"engine\": " << jsonStr(evalEngine == EvalEngine::Column ? "column" : "window")
+       << ",\n  \"kernel\": " << jsonStr(kernelName(lineKernel)) << ",\n  \"batch\": " << batchSize
+       << ",\n  \"sched\": " << jsonStr(schedMode == Sched::Steal ? "steal" : "static") << ",\n  \"chunk\": " << chunkSpins
+       << ",\n  \"seed\": " << runSeed << ",\n  \"hardware_threads\": " << thread::hardware_concurrency()
+#if defined(__VERSION__)
+       << ",\n  \"compiler\": " << jsonStr(__VERSION__)
+#elif defined(_MSC_VER)
+       << ",\n  \"compiler\": " << jsonStr("MSVC " + to_string(_MSC_VER))
+#endif
+       << ",\n  \"micro\": [";
+    for (size_t i = 0; i < micro.size(); i++)
+        js << (i ? "," : "") << "\n    {\"name\": " << jsonStr(micro[i].name) << ", \"ns_per_op\": " << micro[i].nsPerOp
+           << ", \"tsc_per_op\": " << micro[i].tscPerOp << "}";
+    js << "\n  ],\n  \"scaling\": {\"spins\": " << benchSpins << ", \"deterministic\": " << (deterministic ? "true" : "false")
+       << ", \"points\": [";
+    for (size_t i = 0; i < scale.size(); i++)
+        js << (i ? "," : "") << "\n    {\"threads\": " << scale[i].threads << ", \"wall_sec\": " << scale[i].wall
+           << ", \"spins_per_sec\": " << scale[i].spinsPerSec << ", \"speedup\": " << scale[0].wall / scale[i].wall
+           << ", \"rtp\": " << scale[i].rtp << "}";
+    js << "\n  ]}\n}\n";
+    const string text = js.str();
+    if (!writeFileAtomic(benchPath, vector<char>(text.begin(), text.end())))
+        std::fprintf(stderr, "[BENCH] 寫入失敗：%s\n", benchPath.c_str());
+    else
+        std::fprintf(stderr, "[BENCH] 已寫入 %s\n", benchPath.c_str());
+}
 
-        total.bigWins += s.bigWins;
-        total.megaWins += s.megaWins;
-        total.superWins += s.superWins;
-        total.holyWins += s.holyWins;
-        total.jumboWins += s.jumboWins;
-        total.jojoWins += s.jojoWins;
-        for (int bi = 0; bi < NUM_HIGH_BINS; ++bi)
+// 命令列參數：覆寫上方「參數（可調）」
+static bool parseArgs(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        string a = argv[i];
+        auto need = [&]() -> const char *
+        {
+            if (i + 1 >= argc)
+                throw invalid_argument(a + " 缺少參數值");
+            return argv[++i];
+        };
+        try
+        {
+            if (a == "--spins")
+                numSpins = stoll(need());
+            else if (a == "--threads")
+            {
+                numWorkers = stoi(need());
+                threadsGiven = true;
+            }
+            else if (a == "--exact")
+                exactMode = true;
+            else if (a == "--kernel")
+            {
+                string k = need();
+                if (k == "scalar")
+                    lineKernel = LineKernel::Scalar;
+                else if (k == "bitboard")
+                    lineKernel = LineKernel::Bitboard;
+                else if (k == "sse2")
+                    lineKernel = LineKernel::SSE2;
+                else if (k == "avx2")
+                    lineKernel = LineKernel::AVX2;
+                else if (k == "auto")
+                    lineKernel = LineKernel::Auto;
+                else
+                    throw invalid_argument("未知核心 " + k);
+            }
+            else if (a == "--engine")
+            {
+                string e = need();
+                if (e == "window")
+                    evalEngine = EvalEngine::Window;
+                else if (e == "column")
+                    evalEngine = EvalEngine::Column;
+                else
+                    throw invalid_argument("未知引擎 " + e);
+            }
+            else if (a == "--rng")
+            {
+                string r = need();
+                if (r == "mt")
+                    rngKind = RngKind::MT;
+                else if (r == "xoshiro")
+                    rngKind = RngKind::Xoshiro;
+                else if (r == "splitmix")
+                    rngKind = RngKind::SplitMix;
+                else if (r == "philox")
+                    rngKind = RngKind::Philox;
+                else
+                    throw invalid_argument("未知亂數產生器 " + r);
+            }
+            else if (a == "--rng-bench")
+                rngBenchMode = true;
+            else if (a == "--bench")
+                benchPath = need();
+            else if (a == "--bench-spins")
+                benchSpins = stoll(need());
+            else if (a == "--batch")
+                batchSize = stoi(need());
+            else if (a == "--batch-check")
+                batchCheckSpins = stoll(need());
+            else if (a == "--pipeline")
+                pipelineMode = true;
+            else if (a == "--mg-threads")
+                mgThreads = stoi(need());
+            else if (a == "--fg-threads")
+                fgThreads = stoi(need());
+            else if (a == "--sched")
+            {
+                string m = need();
+                if (m == "steal")
+                    schedMode = Sched::Steal;
+                else if (m == "static")
+                    schedMode = Sched::Static;
+                else
+                    throw invalid_argument("未知排程 " + m);
+            }
+            else if (a == "--chunk")
+                chunkSpins = stoll(need());
+            else if (a == "--seed")
+            {
+                runSeed = stoull(need());
+                seedGiven = true;
+            }
+            else if (a == "--telemetry")
+                telemetryPath = need();
+            else if (a == "--telemetry-format")
+            {
+                telemetryFormat = need();
+                if (telemetryFormat != "jsonl" && telemetryFormat != "prom")
+                    throw invalid_argument("未知遙測格式 " + telemetryFormat);
+            }
+            else if (a == "--target-se")
+                targetSE = stod(need());
+            else if (a == "--target-halfwidth")
+                targetSE = stod(need()) / 1.96;
+            else if (a == "--min-triggers")
+                minTriggers = stoll(need());
+            else if (a == "--min-spins")
+                minSpins = stoll(need());
+            else if (a == "--checkpoint")
+                checkpointPath = need();
+            else if (a == "--checkpoint-every")
+                checkpointEverySec = stod(need());
+            else if (a == "--resume")
+                resumePath = need();
+            else if (a == "--chunk-range")
+            {
+                string r = need();
+                size_t colon = r.find(':');
+                if (colon == string::npos)
+                    throw invalid_argument("--chunk-range 格式為 A:B");
+                chunkFirst = stoll(r.substr(0, colon));
+                chunkLast = colon + 1 < r.size() ? stoll(r.substr(colon + 1)) : -1;
+            }
+            else if (a == "--affinity")
+            {
+                string m = need();
+                if (m == "none")
+                    affinityMode = Affinity::None;
+                else if (m == "all")
+                    affinityMode = Affinity::All;
+                else if (m == "physical")
+                    affinityMode = Affinity::Physical;
+                else
+                    throw invalid_argument("未知綁核模式 " + m);
+            }
+            else if (a == "--kernel-check")
+                kernelCheckWindows = stoll(need());
+            else if (a == "--game")
+                gamePaths.push_back(need());
+            else if (a == "--shard")
+            {
+                string r = need();
+                size_t slash = r.find('/');
+                if (slash == string::npos)
+                    throw invalid_argument("--shard 格式為 i/N");
+                shardIndex = stoi(r.substr(0, slash));
+                shardCount = stoi(r.substr(slash + 1));
+            }
+            else if (a == "--shard-out")
+                shardOutPath = need();
+            else if (a == "--merge")
+                mergePaths.push_back(need());
+            else if (a == "--interleave")
+                interleaveGames = true;
+            else if (a == "--breakdown")
+                breakdownMode = true;
+            else if (a == "--percentiles")
+                reportPercentiles = parseList(need());
+            else if (a == "--hist-tiers")
+                reportTiers = parseList(need());
+            else if (a == "--hist-csv")
+                histCsvPath = need();
+            else if (a == "--fg-cache")
+                fgCacheSessions = stoll(need());
+            else if (a == "--fg-cache-file")
+                fgCachePath = need();
+            else if (a == "--fg-cache-check")
+                fgCacheCheck = stoll(need());
+            else if (a == "--conditional")
+                conditionalMode = true;
+            else if (a == "--sessions")
+                sessionCount = stoll(need());
+            else if (a == "--bankroll")
+                sessionBankroll = stod(need());
+            else if (a == "--session-spins")
+                sessionMaxSpins = stoll(need());
+            else if (a == "--stop-win")
+                sessionStopWin = stod(need());
+            else if (a == "--stop-loss")
+                sessionStopLoss = stod(need());
+            else if (a == "--first-k")
+                sessionFirstK = stoll(need());
+            else if (a == "--serve")
+                serveMode = true;
+            else if (a == "--serve-socket")
+            {
+                serveMode = true;
+                serveSocketPath = need();
+            }
+            else if (a == "--sweep")
+                sweepPaths.push_back(need());
+            else if (a == "--sweep-target")
+                sweepTarget = stod(need());
+            else
+                throw invalid_argument("未知參數 " + a);
+        }
+        catch (const exception &e)
         {
-            total.hiWinBins[bi] += s.hiWinBins[bi];
+            std::fprintf(stderr, "[ARGS] %s\n", e.what());
+            return false;
         }
-
-        total.fgZeroBatches += s.fgZeroBatches;
-        total.fgTotalBatches += s.fgTotalBatches;
-
-        total.rtpSum += s.rtpSum;
-        total.rtpSumSq += s.rtpSumSq;
-        total.nSpins += s.nSpins;
     }
+    if (numSpins <= 0)
+    {
+        std::fprintf(stderr, "[ARGS] --spins 必須為正數\n");
+        return false;
+    }
+    if (pipelineMode && (!checkpointPath.empty() || !resumePath.empty() || targetSE > 0))
+    {
+        std::fprintf(stderr, "[ARGS] 管線模式不支援 --checkpoint / --resume / --target-se\n");
+        return false;
+    }
+    if (gamePaths.size() > 1 && (pipelineMode || !checkpointPath.empty() || !resumePath.empty()))
+    {
+        std::fprintf(stderr, "[ARGS] 多個 --game 不支援 --pipeline / --checkpoint / --resume\n");
+        return false;
+    }
+    if (!sweepPaths.empty() && (gamePaths.size() > 1 || pipelineMode || !checkpointPath.empty() ||
+                                !resumePath.empty() || targetSE > 0))
+    {
+        std::fprintf(stderr, "[ARGS] --sweep 只接受一個 --game 作為基準，且不支援 --pipeline / --checkpoint / --resume / --target-se\n");
+        return false;
+    }
+    if (conditionalMode && (exactMode || pipelineMode || !sweepPaths.empty() || !checkpointPath.empty() ||
+                            !resumePath.empty() || targetSE > 0))
+    {
+        std::fprintf(stderr, "[ARGS] --conditional 不可與 --exact / --pipeline / --sweep / --checkpoint / --resume / --target-se 併用\n");
+        return false;
+    }
+    if (!fgCachePath.empty() && max<size_t>(1, gamePaths.size()) + sweepPaths.size() > 1)
+    {
+        std::fprintf(stderr, "[ARGS] --fg-cache-file 只支援單一遊戲\n");
+        return false;
+    }
+    if (breakdownMode && (pipelineMode || conditionalMode || !sweepPaths.empty() || fgCacheSessions > 0 ||
+                          !fgCachePath.empty()))
+    {
+        std::fprintf(stderr, "[ARGS] --breakdown 只用於排程模式（不可與 --pipeline / --conditional / --sweep / --fg-cache 併用）\n");
+        return false;
+    }
+    if (breakdownMode && evalEngine == EvalEngine::Column)
+    {
+        std::fprintf(stderr, "[BREAKDOWN] column 引擎不產生視窗，改用 window\n");
+        evalEngine = EvalEngine::Window;
+    }
+    if (shardIndex >= 0)
+    {
+        if (shardCount <= 0 || shardIndex >= shardCount)
+        {
+            std::fprintf(stderr, "[ARGS] --shard i/N 須滿足 0 ≤ i < N\n");
+            return false;
+        }
+        if (!seedGiven && resumePath.empty())
+        {
+            std::fprintf(stderr, "[ARGS] --shard 需指定 --seed（各分片必須共用同一種子）\n");
+            return false;
+        }
+        if (chunkFirst != 0 || chunkLast != -1 || gamePaths.size() > 1 || exactMode || pipelineMode ||
+            conditionalMode || !sweepPaths.empty() || targetSE > 0)
+        {
+            std::fprintf(stderr, "[ARGS] --shard 不可與 --chunk-range / 多個 --game / --exact / --pipeline / --conditional / --sweep / --target-se 併用\n");
+            return false;
+        }
+    }
+    if (!mergePaths.empty() && (shardIndex >= 0 || gamePaths.size() > 1 || !sweepPaths.empty()))
+    {
+        std::fprintf(stderr, "[ARGS] --merge 不可與 --shard / 多個 --game / --sweep 併用\n");
+        return false;
+    }
+    if (sessionCount > 0)
+    {
+        if (exactMode || pipelineMode || conditionalMode || !sweepPaths.empty() || breakdownMode || shardIndex >= 0 ||
+            !checkpointPath.empty() || !resumePath.empty() || targetSE > 0)
+        {
+            std::fprintf(stderr, "[ARGS] --sessions 不可與 --exact / --pipeline / --conditional / --sweep / --breakdown / --shard / --checkpoint / --resume / --target-se 併用\n");
+            return false;
+        }
+        if (sessionBankroll < 1 || sessionMaxSpins <= 0 || sessionFirstK < 0 || (sessionStopWin != 0 && sessionStopWin <= 1) ||
+            sessionStopLoss <= 0 || sessionStopLoss > 1)
+        {
+            std::fprintf(stderr, "[ARGS] 需 --bankroll ≥ 1、--session-spins > 0、--first-k ≥ 0、--stop-win 為 0 或 > 1、0 < --stop-loss ≤ 1\n");
+            return false;
+        }
+    }
+    if (serveMode && (exactMode || pipelineMode || conditionalMode || max<size_t>(1, gamePaths.size()) > 1 ||
+                      !sweepPaths.empty() || breakdownMode || shardIndex >= 0 || sessionCount > 0 ||
+                      fgCacheSessions > 0 || !fgCachePath.empty() || !checkpointPath.empty() || !resumePath.empty()))
+    {
+        std::fprintf(stderr, "[ARGS] --serve 只接受單一遊戲，不可與 --exact / --pipeline / --conditional / --sweep / --breakdown / --shard / --sessions / --fg-cache / --checkpoint / --resume 併用\n");
+        return false;
+    }
+    if (checkpointEverySec <= 0)
+    {
+        std::fprintf(stderr, "[ARGS] --checkpoint-every 必須為正數\n");
+        return false;
+    }
+    if (chunkSpins <= 0)
+    {
+        std::fprintf(stderr, "[ARGS] --chunk 必須為正數\n");
+        return false;
+    }
+    // 指定 --affinity 而未指定 --threads：worker 數取綁核清單長度（physical = 實體核心數）
+    if (!threadsGiven && affinityMode != Affinity::None)
+        numWorkers = (int)affinityCpus().size();
+    if (pipelineMode)
+    {
+        // 未指定時依 numWorkers 分配：FG 約占 1/4（FG 轉數約為 MG 的 6%，但每串長度不定）
+        int hw = max(2, numWorkers);
+        if (mgThreads <= 0 && fgThreads <= 0)
+            fgThreads = max(1, hw / 4);
+        if (fgThreads <= 0)
+            fgThreads = max(1, hw - mgThreads);
+        if (mgThreads <= 0)
+            mgThreads = max(1, hw - fgThreads);
+    }
+    if (batchSize < 0)
+    {
+        std::fprintf(stderr, "[ARGS] --batch 不可為負數\n");
+        return false;
+    }
+    // 分片 i/N = 總塊數均分後的第 i 段
+    if (shardIndex >= 0)
+    {
+        const long long n = (numSpins + chunkSpins - 1) / chunkSpins;
+        chunkFirst = n * shardIndex / shardCount;
+        chunkLast = n * (shardIndex + 1) / shardCount;
+    }
+    return true;
+}
+
+/**************
+ * 報表：依合併後的 Stats 輸出（轉數取 Stats 實際樣本數）
+ **************/
+static void printReport(const Tally &tally, const GameDef &d)
+{
+    const Stats &total = tally.st;
+    const long long spins = total.nSpins;
+    const double totalBet = (double)spins * (double)numLines * betPerLine;
+    const double perSpinBet = (double)numLines * betPerLine;
 
-    // ===== 統計輸出 =====
-    double totalWin = total.mainLineWinSum + total.freeGameWinSum;
-    double rtpMG = total.mainLineWinSum / totalBet;
-    double rtpFG = total.freeGameWinSum / totalBet;
+    // 整數線注單位 → 金額
+    double winMG = (double)total.mainLineWinSum * betPerLine, winFG = (double)total.freeGameWinSum * betPerLine;
+    double totalWin = (double)(total.mainLineWinSum + total.freeGameWinSum) * betPerLine;
+    double rtpMG = winMG / totalBet;
+    double rtpFG = winFG / totalBet;
     double rtpTotal = totalWin / totalBet;
 
     cout.setf(std::ios::fixed);
     cout << setprecision(6);
-    cout << "=== Monte Carlo | workers=" << numWorkers
-         << " | spins=" << numSpins
+    cout << "=== Monte Carlo | " << d.name << " | ";
+    if (mergedMixed) // 各分片的 worker/批次/引擎設定不同：不列單一組執行設定
+        cout << "merged from " << mergedShards << " shards";
+    else if (pipelineMode)
+        cout << "workers=" << mgThreads << "MG+" << fgThreads << "FG";
+    else
+        cout << "workers=" << numWorkers << (schedMode == Sched::Steal ? " (steal)" : " (static)");
+    if (mergedShards > 0 && !mergedMixed)
+        cout << " ×" << mergedShards << " shards";
+    cout << " | spins=" << spins
+         << " | seed=" << runSeed
+         << " | chunk=" << chunkSpins
          << " | lines=" << numLines
-         << " | bet/line=" << setprecision(2) << betPerLine << " ===\n";
+         << " | bet/line=" << setprecision(2) << betPerLine
+         << " | rng=" << rngName(rngKind);
+    if (!mergedMixed)
+        cout << " | batch=" << batchSize
+             << " | engine=" << (evalEngine == EvalEngine::Column ? "column" : kernelName(lineKernel));
+    cout << " ===\n";
     cout << setprecision(2);
     cout << "總成本 (Total Bet)                    : " << totalBet << "\n";
     cout << "總贏分 (Total Win)                    : " << totalWin << "\n";
-    cout << "最高單把贏分                           : " << total.maxSingleSpin
-         << " (x" << (total.maxSingleSpin / perSpinBet) << ")\n";
+    cout << "最高單把贏分                           : " << (double)total.maxSingleSpin * betPerLine
+         << " (x" << ((double)total.maxSingleSpin * betPerLine / perSpinBet) << ")\n";
     cout << setprecision(6);
     cout << "主遊戲 RTP                            : " << rtpMG << "\n";
     cout << "免費遊戲 RTP                          : " << rtpFG << "\n";
@@ -638,14 +5955,12 @@ int main()
 
     // 觸發與再觸發
     cout << "免費遊戲觸發次數                      : " << total.triggerCount
-         << " (觸發率 " << (double)total.triggerCount / (double)numSpins << ") "
-         << everyStr(numSpins, total.triggerCount) << "\n";
-    cout << "  └×10  次數 (3S)                     : " << total.trigX10
-         << " " << everyStr(numSpins, total.trigX10) << "\n";
-    cout << "  └×50  次數 (4S)                     : " << total.trigX50
-         << " " << everyStr(numSpins, total.trigX50) << "\n";
-    cout << "  └×100 次數 (5S)                     : " << total.trigX100
-         << " " << everyStr(numSpins, total.trigX100) << "\n";
+         << " (觸發率 " << (double)total.triggerCount / (double)spins << ") "
+         << everyStr(spins, total.triggerCount) << "\n";
+    const long long trigByS[3] = {total.trigX10, total.trigX50, total.trigX100};
+    for (int k = 0; k < 3; k++)
+        cout << "  └" << left << setw(6) << mulLabel(d, k + 3) << right << "次數 (" << k + 3
+             << "S)                     : " << trigByS[k] << " " << everyStr(spins, trigByS[k]) << "\n";
 
     double retriRate = 0.0;
     if (total.triggerCount > 0)
@@ -676,21 +5991,13 @@ int main()
     }
 
     cout << "主遊戲 dead spins（無線獎且未觸發FG）: " << total.deadSpins
-         << " (占比 " << (double)total.deadSpins / (double)numSpins << ")\n";
+         << " (占比 " << (double)total.deadSpins / (double)spins << ")\n";
 
     cout << "\n獎項分佈\n";
-    cout << "Big  Win  (≥20×bet)                   : " << total.bigWins
-         << " " << everyStr(numSpins, total.bigWins) << "\n";
-    cout << "Mega Win  (≥60×bet)                   : " << total.megaWins
-         << " " << everyStr(numSpins, total.megaWins) << "\n";
-    cout << "Super Win (≥100×bet)                  : " << total.superWins
-         << " " << everyStr(numSpins, total.superWins) << "\n";
-    cout << "Holy Win (≥300×bet)                   : " << total.holyWins
-         << " " << everyStr(numSpins, total.holyWins) << "\n";
-    cout << "Jumbo Win (≥500×bet)                  : " << total.jumboWins
-         << " " << everyStr(numSpins, total.jumboWins) << "\n";
-    cout << "Jojo Win  (≥1000×bet)                 : " << total.jojoWins
-         << " " << everyStr(numSpins, total.jojoWins) << "\n";
+    const long long tierCnt[6] = {total.bigWins, total.megaWins, total.superWins,
+                                  total.holyWins, total.jumboWins, total.jojoWins};
+    for (int i = 0; i < 6; i++)
+        cout << tierLabel(d, i) << "                 : " << tierCnt[i] << " " << everyStr(spins, tierCnt[i]) << "\n";
 
     cout << "\n≥1000倍大獎細分\n";
     for (int bi = 0; bi < NUM_HIGH_BINS; ++bi)
@@ -698,16 +6005,35 @@ int main()
         long long cnt = total.hiWinBins[bi];
         int edge = static_cast<int>(HIGH_BIN_EDGES[bi]);
         cout << "≥" << setw(5) << edge << "×bet    : "
-             << cnt << ' ' << everyStr(numSpins, cnt) << '\n';
+             << cnt << ' ' << everyStr(spins, cnt) << '\n';
+    }
+
+    // 分佈直方圖（格寬 ≤ 1/32 相對誤差；分位為格內線性內插）
+    const WinHist &H = tally.dist.spin;
+    const double hn = (double)H.total();
+    cout << "\n贏分分佈（log 直方圖，×bet）\n";
+    cout << "中獎率（>0×）                         : " << (hn - (double)H.n[0]) / hn << "\n";
+    cout << "未回本中獎率（0 < 贏分 < 1×）         : " << (H.countAtLeast(1e-300) - H.countAtLeast(1.0)) / hn << "\n";
+    for (double q : reportPercentiles)
+    {
+        ostringstream lab;
+        lab << "P" << q;
+        cout << left << setw(8) << lab.str() << right << " 單把 / MG 線獎 / FG 串 base    : " << H.quantile(q / 100)
+             << " / " << tally.dist.mg.quantile(q / 100) << " / " << tally.dist.fg.quantile(q / 100) << "\n";
+    }
+    for (double t : reportTiers)
+    {
+        ostringstream lab;
+        lab << t;
+        double c = H.countAtLeast(t);
+        cout << "≥" << setw(6) << lab.str() << "×bet   : " << scientific << c / hn << fixed << " "
+             << everyStr(spins, llround(c)) << "\n";
     }
 
     // 統計驗證（per-spin RTP 的均值/方差/95% CI）
     double n = (double)total.nSpins;
-    double mean = total.rtpSum / n;
-    double meanSq = total.rtpSumSq / n;
-    double variance = meanSq - mean * mean;
-    if (variance < 0)
-        variance = 0;
+    double mean = spinRtpMean(total);
+    double variance = spinRtpVar(total);
     double se = sqrt(variance / n);
     double lo = mean - 1.96 * se, hi = mean + 1.96 * se;
 
@@ -721,7 +6047,7 @@ int main()
     cout << "標準誤差 SE                           : " << se << "\n";
     cout << "95% 信賴區間                         : [" << lo << ", " << hi << "]\n";
 
-    if (excelRTP >= 0)
+    if (excelRTP >= 0 && d.builtin) // Excel 試算只對應內建遊戲
     {
         double z = (excelRTP - mean) / (se > 0 ? se : 1e-12);
         bool inCI = (excelRTP >= lo && excelRTP <= hi);
@@ -733,5 +6059,341 @@ int main()
         cout << (inCI ? "結論：Excel 值落在本次 95% CI 之內（可視為誤差內）。\n"
                       : "結論：Excel 值不在本次 95% CI 之內（建議檢查）。\n");
     }
+}
+
+// RTP 貢獻矩陣：符號 × 連線數 × 模式、逐線、含 W 與否（皆為占總押注之比例，各欄加總 = 該模式 RTP）
+static void printBreakdown(const Tally &tally, const GameDef &d)
+{
+    const Stats &total = tally.st;
+    static const char *symLabel[NumSymbols] = {"9", "10", "J", "Q", "K", "R", "F", "B", "W", "S"};
+    const LineBreakdown &b = *tally.br;
+    const double bet = (double)total.nSpins * numLines, n = (double)total.nSpins; // 線注單位
+    cout << "\n=== RTP 貢獻矩陣 | " << d.name << " ===\n";
+    cout.setf(std::ios::fixed);
+    cout << setprecision(6);
+    cout << "符號    MG 3連    MG 4連    MG 5連    FG 3連    FG 4連    FG 5連      合計\n";
+    long long col[2][3] = {};
+    for (int t = 0; t < NumSymbols; t++)
+    {
+        long long row = 0;
+        for (int m = 0; m < 2; m++)
+            for (int k = 0; k < 3; k++)
+                row += b.symWin[m][t][k];
+        if (row == 0)
+            continue;
+        cout << left << setw(4) << symLabel[t] << right;
+        for (int m = 0; m < 2; m++)
+            for (int k = 0; k < 3; k++)
+            {
+                cout << setw(10) << (double)b.symWin[m][t][k] / bet;
+                col[m][k] += b.symWin[m][t][k];
+            }
+        cout << setw(10) << (double)row / bet << "\n";
+    }
+    cout << "合計";
+    long long all = 0;
+    for (int m = 0; m < 2; m++)
+        for (int k = 0; k < 3; k++)
+        {
+            cout << setw(10) << (double)col[m][k] / bet;
+            all += col[m][k];
+        }
+    cout << setw(10) << (double)all / bet << "\n";
+
+    cout << "\n命中率（每轉；FG 欄以 MG 轉數為分母）\n";
+    for (int t = 0; t < NumSymbols; t++)
+    {
+        long long hits = 0;
+        for (int m = 0; m < 2; m++)
+            for (int k = 0; k < 3; k++)
+                hits += b.symHits[m][t][k];
+        if (!hits)
+            continue;
+        cout << left << setw(4) << symLabel[t] << right << scientific << setprecision(3);
+        for (int m = 0; m < 2; m++)
+            for (int k = 0; k < 3; k++)
+                cout << setw(10) << (double)b.symHits[m][t][k] / n;
+        cout << fixed << setprecision(6) << "\n";
+    }
+
+    cout << "\n逐線貢獻（MG RTP / FG RTP / MG 命中率）\n";
+    for (int l = 0; l < numLines; l++)
+        cout << "線 " << setw(2) << l + 1 << "  : " << (double)b.lineWin[MG][l] / bet << " / " << (double)b.lineWin[FG][l] / bet << " / "
+             << (double)b.lineHits[MG][l] / n << "\n";
+
+    cout << "\n自然連線 vs 含 W 代替（RTP / 次數）\n";
+    const char *kind[2] = {"自然", "含 W"};
+    for (int m = 0; m < 2; m++)
+        for (int k = 0; k < 2; k++)
+            cout << (m == MG ? "MG " : "FG ") << kind[k] << "                               : " << (double)b.kindWin[m][k] / bet
+                 << " / " << b.kindHits[m][k] << "\n";
+}
+
+// 整份直方圖匯出：game,hist,lower,upper,count（append：多遊戲依序接在同一檔）
+static bool writeHistCsv(const string &path, const WinDist &s, const string &game, bool append)
+{
+    ofstream out(path, append ? ios::app : ios::trunc);
+    if (!out)
+        return false;
+    if (!append)
+        out << "game,hist,lower,upper,count\n";
+    const pair<const char *, const WinHist *> hs[] = {{"spin", &s.spin}, {"mg", &s.mg}, {"fg_base", &s.fg}};
+    out << setprecision(10);
+    for (const auto &h : hs)
+        for (int i = 0; i < WinHist::BUCKETS; i++)
+            if (h.second->n[i])
+                out << game << ',' << h.first << ',' << WinHist::lower(i) << ',' << WinHist::upper(i) << ','
+                    << h.second->n[i] << '\n';
+    return (bool)out;
+}
+
+// 一個遊戲的完整輸出：報表、貢獻矩陣（--breakdown）、直方圖 CSV（--hist-csv；第二個遊戲起附加）
+static void emitReport(const Tally &total, const GameDef &d, bool appendCsv)
+{
+    printReport(total, d);
+    if (breakdownMode && total.br)
+        printBreakdown(total, d);
+    if (!histCsvPath.empty() && !writeHistCsv(histCsvPath, total.dist, d.name, appendCsv))
+        std::fprintf(stderr, "[HIST] 寫入失敗：%s\n", histCsvPath.c_str());
+}
+
+// --merge：讀入所有分片，檢查同一實驗、範圍不重疊，依塊號合併後輸出與單機相同的報表
+static int runMerge()
+{
+    vector<ShardFile> parts;
+    try
+    {
+        for (const string &p : mergePaths)
+            parts.push_back(loadShard(p));
+    }
+    catch (const exception &e)
+    {
+        std::fprintf(stderr, "[MERGE] %s\n", e.what());
+        return 1;
+    }
+
+    const ShardHeader &h0 = parts[0].h;
+    for (const ShardFile &p : parts)
+    {
+        const ShardHeader &h = p.h;
+        if (h.seed != h0.seed || h.spins != h0.spins || h.chunk != h0.chunk || h.rng != h0.rng ||
+            h.flags != h0.flags || h.gameKey != h0.gameKey || h.shards != h0.shards)
+        {
+            std::fprintf(stderr, "[MERGE] %s 與 %s 的 seed/spins/chunk/rng/遊戲/分片數/模式不一致\n",
+                         p.path.c_str(), parts[0].path.c_str());
+            return 1;
+        }
+    }
+    if (h0.gameKey != gameKey(games[0]->def))
+    {
+        std::fprintf(stderr, "[MERGE] 分片的遊戲定義與目前的 --game（或內建）不符\n");
+        return 1;
+    }
+
+    sort(parts.begin(), parts.end(), [](const ShardFile &a, const ShardFile &b)
+         { return a.h.first < b.h.first; });
+    const long long n = (h0.spins + h0.chunk - 1) / h0.chunk;
+    long long next = 0, covered = 0;
+    for (const ShardFile &p : parts)
+    {
+        if (p.h.first < next)
+        {
+            std::fprintf(stderr, "[MERGE] %s 的塊 [%lld, %lld) 與前一分片重疊\n", p.path.c_str(),
+                         (long long)p.h.first, (long long)p.h.last);
+            return 1;
+        }
+        if (p.h.first > next)
+            std::fprintf(stderr, "[MERGE] 缺少塊 [%lld, %lld)：報表只含已提供的分片\n", next, (long long)p.h.first);
+        next = p.h.last;
+        covered += p.h.last - p.h.first;
+    }
+    if (next < n)
+        std::fprintf(stderr, "[MERGE] 缺少塊 [%lld, %lld)：報表只含已提供的分片\n", next, n);
+
+    runSeed = h0.seed;
+    numSpins = h0.spins;
+    chunkSpins = h0.chunk;
+    rngKind = (RngKind)h0.rng;
+    breakdownMode = (h0.flags & SHARD_BREAKDOWN) != 0;
+    evalEngine = (EvalEngine)h0.engine;
+    lineKernel = (LineKernel)h0.kernel;
+    schedMode = (Sched)h0.sched;
+    numWorkers = h0.workers;
+    batchSize = h0.batch;
+    mergedShards = (int)parts.size();
+    for (const ShardFile &p : parts)
+        mergedMixed = mergedMixed || p.h.engine != h0.engine || p.h.kernel != h0.kernel || p.h.sched != h0.sched ||
+                      p.h.workers != h0.workers || p.h.batch != h0.batch;
+
+    Tally total{};
+    for (const ShardFile &p : parts)
+        total.merge(p.total);
+    std::fprintf(stderr, "[MERGE] %zu 個分片（共 %d 片）| 塊 %lld/%lld | %lld 轉%s\n", parts.size(), h0.shards,
+                 covered, n, total.st.nSpins, (h0.flags & SHARD_FG_CACHE) ? " | FG 快取抽樣" : "");
+    emitReport(total, games[0]->def, false);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+#ifdef _WIN32
+    // 主控台改用 UTF-8，避免 中文/符號 亂碼（與 /utf-8 編譯搭配）
+    SetConsoleOutputCP(65001);
+    SetConsoleCP(65001);
+#endif
+
+    ios::sync_with_stdio(false);
+    cin.tie(nullptr);
+
+    if (!parseArgs(argc, argv))
+        return 1;
+
+    if (numWorkers <= 0)
+        numWorkers = 1;
+
+    // 遊戲定義（--game，未指定時為內建）→ 輪帶/賠率/線型編譯成各核心所需的表
+    try
+    {
+        buildGames();
+    }
+    catch (const exception &e)
+    {
+        std::fprintf(stderr, "[GAME] %s\n", e.what());
+        return 1;
+    }
+
+    if (!mergePaths.empty())
+        return runMerge();
+
+    // 線獎核心：整數賠率表 + 自檢
+    if (kernelCheckWindows > 0)
+    {
+        resolveKernel();
+        bool ok = kernelSelfCheck(games[0]->def, games[0]->bb, kernelCheckWindows, true);
+        std::fprintf(stderr, "[KERNEL] 自檢%s | 使用中：%s\n", ok ? "通過" : "失敗", kernelName(lineKernel));
+        return ok ? 0 : 2;
+    }
+    resolveKernel();
+
+    if (batchCheckSpins > 0)
+        return batchSelfCheck(batchCheckSpins) ? 0 : 2;
+
+    if (rngBenchMode)
+    {
+        runRngBench();
+        return 0;
+    }
+
+    if (!benchPath.empty())
+    {
+        if (!seedGiven)
+            runSeed = 1; // 基準測試固定種子，擴展測試的 RTP 才可跨次比對
+        runBench();
+        return 0;
+    }
+
+    // 精確模式：窮舉後直接結束
+    if (exactMode)
+    {
+        for (const auto &g : games)
+            runExact(*g);
+        return 0;
+    }
+
+    if (!resumePath.empty())
+    {
+        try
+        {
+            loadCheckpoint(resumePath);
+        }
+        catch (const exception &e)
+        {
+            std::fprintf(stderr, "[CKPT] %s\n", e.what());
+            return 1;
+        }
+        if (checkpointPath.empty())
+            checkpointPath = resumePath; // 續跑時預設繼續寫回同一檔
+    }
+
+    // 即時統計（每秒報告；排程模式每 worker 一個快照槽位）
+    Stats resumedTotal = resumePrefixTally.st;
+    for (const auto &p : resumePending)
+        mergeStats(resumedTotal, p.second.st);
+    if (!pipelineMode)
+    {
+        liveSlots.reset(new LiveSlot[numWorkers]);
+        liveSlotCount = numWorkers;
+    }
+    if (!seedGiven)
+        runSeed = (uint64_t)chrono::high_resolution_clock::now().time_since_epoch().count();
+
+    // FG 串快取（條件蒙地卡羅本身即在模擬 FG 串，不使用）
+    if ((fgCacheSessions > 0 || !fgCachePath.empty()) && !conditionalMode)
+        withRng(rngKind, [&](auto tag)
+                { prepareFgCaches<typename decltype(tag)::type>(); });
+
+    // 單把服務模式：SlotEngine 逐請求回應，結束時輸出延遲分位
+    if (serveMode)
+    {
+        int rc = 0;
+        withRng(rngKind, [&](auto tag)
+                { rc = runServe<typename decltype(tag)::type>(*games[0]); });
+        return rc;
+    }
+
+    // 玩家 session 模式：每個遊戲各一份分佈報表
+    if (sessionCount > 0)
+    {
+        withRng(rngKind, [&](auto tag)
+                {
+            for (const auto &g : games)
+                runSessions<typename decltype(tag)::type>(*g); });
+        return 0;
+    }
+
+    // 排程模式每個遊戲各跑一遍；掃描模式各變體共用同一把，只計一次
+    const long long perRange = sweepPaths.empty() ? (long long)games.size() : 1;
+    Telemetry telemetry(rangeSpins() * perRange - resumedTotal.nSpins, resumedTotal);
+
+    if (conditionalMode)
+    {
+        withRng(rngKind, [&](auto tag)
+                {
+            for (const auto &g : games)
+                runConditional<typename decltype(tag)::type>(*g); });
+        telemetry.stop();
+        return 0;
+    }
+
+    if (!sweepPaths.empty())
+    {
+        vector<SweepStats> sweep;
+        withRng(rngKind, [&](auto tag)
+                { sweep = runSweep<typename decltype(tag)::type>(); });
+        telemetry.stop();
+        printSweep(sweep);
+        return 0;
+    }
+
+    vector<Tally> stats; // [遊戲]
+    withRng(rngKind, [&](auto tag)
+            {
+        using R = typename decltype(tag)::type;
+        if (pipelineMode)
+            stats.push_back(runPipeline<R>(*games[0], runSeed));
+        else
+            stats = breakdownMode ? runScheduled<R, LineProbe>() : runScheduled<R>(); });
+
+    // 停遙測（join）
+    telemetry.stop();
+
+    // 每個遊戲各一份報表
+    for (size_t k = 0; k < stats.size(); k++)
+        emitReport(stats[k], games[k]->def, k > 0);
+
+    // 分片：範圍合併後的 Tally 寫檔，供 --merge 合併
+    if (shardIndex >= 0 && !writeShard(*games[0], chunkRange().first, chunkRange().second, stats[0]))
+        return 1;
     return 0;
 }
+#endif // SLOT_NO_MAIN